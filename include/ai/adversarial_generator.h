@@ -0,0 +1,115 @@
+#ifndef _AI_ADVERSARIALGENERATOR_H_
+#define _AI_ADVERSARIALGENERATOR_H_
+
+#include <cstdint>
+#include <chrono>
+#include <random>
+
+#include "generator.h"
+#include "ai/eval/eval_func.h"
+
+namespace _2048 {
+namespace ai {
+
+/**
+ * A `Generator` that adds the tile that hurts the player most, for stress
+ * runs against the worst case.
+ *
+ * The generator searches with alpha-beta minimax: it tries every empty tile
+ * with a 2 and with a 4, assumes the player answers with the best move by an
+ * evaluation function, and adds the tile whose value for the player is the
+ * lowest. Positions without a legal move are worth
+ * `EvaluationFunction::kOver`, so a tile that ends the game is always added.
+ * Among equally bad tiles, one is chosen at random.
+ *
+ * The depth counts the player moves looked ahead, including the answer to the
+ * new tile, and the values are taken right after the last of them. The
+ * default depth of 2 takes tens of microseconds on 4 by 4 games, so thousands
+ * of games take seconds. With a time limit, the search deepens one move at a
+ * time up to the depth, trying the worst tiles of the last iteration first,
+ * and adds the worst tile of the last complete iteration; an interrupted
+ * iteration is thrown away, except that depth 1 is always completed.
+ *
+ * 4 by 4 games are searched on `BitBoard4x4`; other sizes are searched on
+ * `GameState` with undo records.
+ */
+class AdversarialGenerator : public Generator {
+ public:
+    AdversarialGenerator(const AdversarialGenerator &) = delete;
+    AdversarialGenerator &operator=(const AdversarialGenerator &) = delete;
+
+    /**
+     * Construct an AdversarialGenerator.
+     * @param eval the evaluation function of the player, which must outlive
+     *      the generator
+     * @param depth the number of player moves to look ahead
+     * @param time_limit the time for each tile, or 0 for no limit
+     * @param seed the seed of the choice among equally bad tiles
+     * @throw std::invalid_argument if `eval` is null, or `depth` is 0 or
+     *      greater than `kMaxDepth`
+     */
+    explicit AdversarialGenerator(const eval::EvaluationFunction *eval,
+                                  uint32_t depth = kDefaultDepth,
+                                  std::chrono::milliseconds time_limit =
+                                          std::chrono::milliseconds(0),
+                                  uint64_t seed = 0);
+
+    /** Default search depth */
+    static constexpr uint32_t kDefaultDepth = 2;
+
+    /** Maximum search depth */
+    static constexpr uint32_t kMaxDepth = 255;
+
+    /**
+     * Generate the worst tile for the player.
+     * @param state the current game state
+     * @param pos output the position of the new tile
+     * @param power output the number in the new tile in terms of power of 2
+     * @return true if there is an empty tile, otherwise false
+     * @throw std::runtime_error if `state` is not valid
+     */
+    bool Generate(const GameState &state, GameState::Position *pos,
+                  uint8_t *power) override;
+
+    /**
+     * Get the depth of the last complete iteration of the last `Generate`.
+     * @return the depth in player moves, or 0 if there was no empty tile
+     */
+    uint32_t depth() const noexcept { return searched_depth_; }
+
+    /**
+     * Get the player value of the tile chosen by the last `Generate`.
+     * @return the value, from the last complete iteration
+     */
+    int64_t value() const noexcept { return value_; }
+
+    /**
+     * Get the number of nodes visited by the last `Generate`, including the
+     * nodes of an interrupted iteration.
+     * @return the number of player and generator nodes
+     */
+    uint64_t nodes() const noexcept { return nodes_; }
+
+ private:
+    const eval::EvaluationFunction *eval_;  /**< Evaluation function */
+    uint32_t max_depth_;                    /**< Search depth */
+    std::chrono::milliseconds time_limit_;  /**< Time for each tile */
+    std::default_random_engine engine_;     /**< Engine to break ties */
+    uint32_t searched_depth_;               /**< Depth of last tile */
+    int64_t  value_;                        /**< Value of last tile */
+    uint64_t nodes_;                        /**< Nodes visited by last tile */
+
+    /**
+     * Choose a tile on a game state of a specific type.
+     * @tparam State `BitBoard4x4` or `GameState`
+     * @param state the current game state, with at least one empty tile
+     * @return the tile, as twice the index of the empty tile, plus 1 for a 4
+     */
+    template <typename State>
+    uint32_t Search(State state);
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_ADVERSARIALGENERATOR_H_
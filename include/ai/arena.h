@@ -0,0 +1,115 @@
+#ifndef _AI_ARENA_H_
+#define _AI_ARENA_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+
+namespace _2048 {
+namespace ai {
+
+/**
+ * A fixed-size pool of objects allocated by bumping an index, for search
+ * trees that are built up node by node and thrown away all at once.
+ *
+ * The objects are allocated once, up front, and addressed by 32-bit indices.
+ * `Allocate` is lock-free and may be called from several threads at once.
+ * Objects are never freed one by one; `Reset` makes the whole pool available
+ * again, and `Truncate` the objects from an index on. An allocated object
+ * keeps whatever its previous user left in it, so the caller initializes it.
+ * @tparam T the type of the objects, trivially destructible
+ */
+template <typename T>
+class Arena {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "arena objects are never destroyed");
+
+ public:
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    /** Index returned when the arena is full */
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    /**
+     * Construct an arena.
+     * @param megabytes the memory budget; the arena holds as many objects as
+     *      fit, and at least one
+     */
+    explicit Arena(size_t megabytes)
+            : capacity_(Capacity(megabytes)),
+              objects_(new T[capacity_]),
+              used_(0) { }
+
+    /**
+     * Get the number of objects the arena can hold.
+     * @return the capacity
+     */
+    size_t capacity() const noexcept { return capacity_; }
+
+    /**
+     * Get the number of allocated objects.
+     * @return the number of objects allocated since the last `Reset`
+     */
+    size_t size() const noexcept {
+        return std::min<uint64_t>(used_.load(std::memory_order_relaxed),
+                                  capacity_);
+    }
+
+    /**
+     * Allocate an object.
+     * @return the index of the object, or `kNone` if the arena is full
+     */
+    uint32_t Allocate() noexcept {
+        const uint64_t index = used_.fetch_add(1, std::memory_order_relaxed);
+        return index < capacity_ ? static_cast<uint32_t>(index) : kNone;
+    }
+
+    /**
+     * Make all objects available again. No other thread may use the arena
+     * during the call.
+     */
+    void Reset() noexcept { used_.store(0, std::memory_order_relaxed); }
+
+    /**
+     * Make the objects from an index on available again, keeping those
+     * before it. No other thread may use the arena during the call.
+     * @param size the number of objects to keep, at most `size()`
+     */
+    void Truncate(size_t size) noexcept {
+        used_.store(std::min(size, this->size()), std::memory_order_relaxed);
+    }
+
+    /**
+     * Access an object.
+     * @param index the index of an allocated object
+     * @return the object
+     */
+    T &operator[](uint32_t index) noexcept { return objects_[index]; }
+    const T &operator[](uint32_t index) const noexcept {
+        return objects_[index];
+    }
+
+ private:
+    size_t capacity_;                   /**< Number of objects */
+    std::unique_ptr<T[]> objects_;      /**< Objects */
+    std::atomic<uint64_t> used_;        /**< Allocations since last reset */
+
+    /**
+     * Compute the number of objects for a memory budget.
+     * @param megabytes the memory budget
+     * @return the number of objects that fit, between 1 and `kNone`
+     */
+    static size_t Capacity(size_t megabytes) noexcept {
+        const size_t count = megabytes * 1024 * 1024 / sizeof(T);
+        return std::clamp<size_t>(count, 1, kNone);
+    }
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_ARENA_H_
@@ -0,0 +1,114 @@
+#ifndef _AI_BOARDBATCH_H_
+#define _AI_BOARDBATCH_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+#include <type_traits>
+
+#include "bit_board_4x4.h"
+#include "ai/thread_pool.h"
+
+namespace _2048 {
+namespace ai {
+
+/**
+ * A batch of 4 by 4 boards stored contiguously, to evaluate them all in one
+ * call, optionally split over a thread pool in chunks of `kChunk` boards.
+ */
+class BoardBatch {
+ public:
+    /** Number of boards per task on a thread pool */
+    static constexpr size_t kChunk = 4096;
+
+    /**
+     * Construct a batch of empty boards.
+     * @param size the number of boards
+     */
+    explicit BoardBatch(size_t size) : boards_(size, 0) { }
+
+    /**
+     * Construct a batch of copies of a board.
+     * @param size the number of boards
+     * @param board the initial board
+     */
+    BoardBatch(size_t size, BitBoard4x4 board) : boards_(size, board.raw()) { }
+
+    /**
+     * Get the number of boards.
+     * @return the number of boards
+     */
+    size_t size() const noexcept { return boards_.size(); }
+
+    /**
+     * Get a board.
+     * @param i the index of the board
+     * @pre `i < size()`
+     * @return the board
+     */
+    BitBoard4x4 board(size_t i) const noexcept {
+        return BitBoard4x4(boards_[i]);
+    }
+
+    /**
+     * Replace a board.
+     * @param i the index of the board
+     * @param board the new board
+     * @pre `i < size()`
+     */
+    void SetBoard(size_t i, BitBoard4x4 board) noexcept {
+        boards_[i] = board.raw();
+    }
+
+    /**
+     * Evaluate every board.
+     * When `Eval` is a concrete evaluation function, the calls are not
+     * virtual.
+     * @tparam Eval the type of the evaluation function
+     * @param eval the evaluation function
+     * @param values output `size()` values, one per board
+     * @param pool the thread pool to split the batch over, or `nullptr`
+     */
+    template <typename Eval>
+    void Evaluate(const Eval &eval, int64_t *values,
+                  ThreadPool *pool = nullptr) const {
+        ForEachChunk(pool, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                const BitBoard4x4 board(boards_[i]);
+                if constexpr (std::is_abstract<Eval>::value)
+                    values[i] = eval(board);
+                else
+                    values[i] = eval.Eval::operator()(board);
+            }
+        });
+    }
+
+ private:
+    std::vector<uint64_t> boards_;  /**< Packed boards */
+
+    /**
+     * Run a loop body over the whole batch, in chunks on a thread pool if
+     * there are more boards than one chunk.
+     * @tparam Body a callable taking the range [begin, end) of boards
+     * @param pool the thread pool, or `nullptr`
+     * @param body the loop body
+     */
+    template <typename Body>
+    void ForEachChunk(ThreadPool *pool, const Body &body) const {
+        if (pool == nullptr || pool->size() == 1 || size() <= kChunk) {
+            body(0, size());
+            return;
+        }
+        pool->Run((size() + kChunk - 1) / kChunk,
+                  [&](uint32_t thread, uint32_t chunk) {
+                      const size_t begin = chunk * kChunk;
+                      body(begin, std::min(begin + kChunk, size()));
+                  });
+    }
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_BOARDBATCH_H_
@@ -5,6 +5,7 @@
 #include <limits>
 
 #include "game_state.h"
+#include "bit_board_4x4.h"
 
 namespace _2048 {
 namespace ai {
@@ -26,6 +27,14 @@ class EvaluationFunction {
     /** Game over */
     static constexpr int64_t kOver = -1000000000000000000;
 
+    /**
+     * Bounds of the values of an evaluation function.
+     */
+    struct Range {
+        int64_t lower;  /**< No value is less than this */
+        int64_t upper;  /**< No value is greater than this */
+    };
+
     /**
      * Evaluate the game state.
      * @param state the game state to be evaluated
@@ -34,6 +43,32 @@ class EvaluationFunction {
      */
     virtual int64_t operator()(const GameState &state) const = 0;
 
+    /**
+     * Evaluate a packed 4 by 4 board.
+     * The default implementation converts `board` into a `GameState`;
+     * evaluation functions should override it with a direct computation.
+     * @param board the board to be evaluated
+     * @return the value of the board (to the player)
+     */
+    virtual int64_t operator()(const BitBoard4x4 &board) const {
+        return (*this)(board.ToGameState());
+    }
+
+    /**
+     * Get bounds of the values of all states of a size whose tiles are at
+     * most 2^`max_power`. Searches use the bounds to prune.
+     * The default implementation returns `kNegInf` and `kPosInf`, which
+     * means the values are not bounded.
+     * @param height the height of the states
+     * @param width the width of the states
+     * @param max_power the largest power of a tile
+     * @return the bounds
+     */
+    virtual Range GetRange(uint32_t height, uint32_t width,
+                           uint8_t max_power) const {
+        return Range{kNegInf, kPosInf};
+    }
+
     /**
      * Destructor
      */
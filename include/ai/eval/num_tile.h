@@ -15,6 +15,9 @@ namespace eval {
 class NumTile : public EvaluationFunction {
  public:
     int64_t operator()(const GameState &state) const override;
+    int64_t operator()(const BitBoard4x4 &board) const override;
+    Range GetRange(uint32_t height, uint32_t width,
+                   uint8_t max_power) const override;
 };
 
 }  // namespace eval
@@ -34,6 +34,20 @@ class WeightTable : public EvaluationFunction {
      */
     int64_t operator()(const GameState &state) const override;
 
+    /**
+     * @copydoc EvaluationFunction::operator()(const BitBoard4x4 &) const
+     * @throw std::invalid_argument if the weight table is not 4 by 4
+     */
+    int64_t operator()(const BitBoard4x4 &board) const override;
+
+    /**
+     * @copydoc EvaluationFunction::GetRange
+     * @throw std::invalid_argument if `height` and `width` are not the size
+     *      of the weight table
+     */
+    Range GetRange(uint32_t height, uint32_t width,
+                   uint8_t max_power) const override;
+
  protected:
     /**
      * Constructor
@@ -59,7 +73,7 @@ class WeightTable : public EvaluationFunction {
      * @param c the col index
      * @return the weight
      */
-    int64_t weight(uint32_t r, uint32_t c) noexcept {
+    int64_t weight(uint32_t r, uint32_t c) const noexcept {
         return weights_[r * width_ + c];
     }
 };
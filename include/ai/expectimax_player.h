@@ -0,0 +1,183 @@
+#ifndef _AI_EXPECTIMAXPLAYER_H_
+#define _AI_EXPECTIMAXPLAYER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "player.h"
+#include "ai/eval/eval_func.h"
+#include "ai/transposition_table.h"
+
+namespace _2048 {
+namespace ai {
+
+class ThreadPool;
+
+/**
+ * A `Player` that searches with expectimax against the tile distribution of
+ * `RandomGenerator`, valuing the leaves with an evaluation function.
+ *
+ * Pruning and threads do not change the chosen move. A probability threshold
+ * values unlikely player nodes by the evaluation function instead of
+ * searching them. A deadline, a node limit or a stop flag in `SearchLimits`
+ * deepens one move at a time and plays the last complete iteration.
+ */
+class ExpectimaxPlayer : public Player {
+ public:
+    ExpectimaxPlayer(const ExpectimaxPlayer &) = delete;
+    ExpectimaxPlayer &operator=(const ExpectimaxPlayer &) = delete;
+
+    /**
+     * Construct an ExpectimaxPlayer.
+     * @param eval the evaluation function, which must outlive the player
+     * @param depth the number of player moves to look ahead, including the
+     *      move being chosen
+     * @param table_mb the memory budget of the transposition table in
+     *      megabytes, or 0 for no table
+     * @param min_probability the probability below which player nodes are
+     *      not searched, or 0 to search every node to full depth
+     * @param prune whether to prune with the range of the evaluation function
+     * @param threads the number of threads to search with, or 0 for one
+     *      thread per hardware thread of the machine
+     * @throw std::invalid_argument if `eval` is null, `depth` is 0 or greater
+     *      than `kMaxDepth`, or `min_probability` is not in [0, 1]
+     */
+    ExpectimaxPlayer(const eval::EvaluationFunction *eval, uint32_t depth,
+                     size_t table_mb = 0, double min_probability = 0,
+                     bool prune = false, uint32_t threads = 1);
+
+    /**
+     * Construct an ExpectimaxPlayer that searches on a shared thread pool.
+     * @param eval the evaluation function, which must outlive the player
+     * @param depth the number of player moves to look ahead, including the
+     *      move being chosen
+     * @param table_mb the memory budget of the transposition table in
+     *      megabytes, or 0 for no table
+     * @param min_probability the probability below which player nodes are
+     *      not searched, or 0 to search every node to full depth
+     * @param prune whether to prune with the range of the evaluation function
+     * @param pool the thread pool, which must outlive the player
+     * @throw std::invalid_argument if `eval` is null, `depth` is 0 or greater
+     *      than `kMaxDepth`, or `min_probability` is not in [0, 1]
+     */
+    ExpectimaxPlayer(const eval::EvaluationFunction *eval, uint32_t depth,
+                     size_t table_mb, double min_probability, bool prune,
+                     ThreadPool &pool);
+
+    /**
+     * Destructor
+     */
+    ~ExpectimaxPlayer() noexcept override;
+
+    /** Maximum search depth, limited by the depth stored in the table */
+    static constexpr uint32_t kMaxDepth = 255;
+
+    /** Type of the transposition table */
+    using Table = TranspositionTable<double>;
+
+    bool Play(const GameState &state, GameState::Direction *move) override;
+    bool Play(const GameState &state, GameState::Direction *move,
+              const SearchLimits &limits) override;
+
+    /**
+     * Get the search depth.
+     * @return the number of player moves to look ahead
+     */
+    uint32_t depth() const noexcept { return depth_; }
+
+    /**
+     * Get the depth of the last complete iteration of the last `Play`.
+     * @return the depth in player moves, or 0 if there was no legal move
+     */
+    uint32_t searched_depth() const noexcept { return searched_depth_; }
+
+    /**
+     * Get the number of threads the player searches with.
+     * @return the number of threads
+     */
+    uint32_t threads() const noexcept;
+
+    /**
+     * Get the number of nodes visited by the last `Play`.
+     * @return the number of player and chance nodes
+     */
+    uint64_t nodes() const noexcept { return nodes_; }
+
+    /**
+     * Get the number of player nodes of the last `Play` that were evaluated
+     * because their probability was below the threshold.
+     * @return the number of nodes cut off
+     */
+    uint64_t cutoffs() const noexcept { return cutoffs_; }
+
+    /**
+     * Get the number of nodes of the last `Play` that were not searched
+     * because a result stored by an earlier play decided them. Hits that only
+     * gave a player node its first move to try are not counted.
+     * With a probability threshold, a stored result only decides a node
+     * reached with the same probability, and the nodes of an earlier play
+     * are less likely, so nothing is reused across plays.
+     * @return the number of reused nodes, over the tables of all threads
+     */
+    uint64_t reused() const noexcept { return reused_; }
+
+    /**
+     * Get the transposition table of a thread, for its counters.
+     * @param thread the index of the thread
+     * @return the table, or null if the player has none
+     */
+    const Table *table(uint32_t thread = 0) const noexcept {
+        return tables_.empty() ? nullptr : tables_[thread].get();
+    }
+
+ private:
+    const eval::EvaluationFunction *eval_;  /**< Evaluation function */
+    uint32_t depth_;                        /**< Search depth */
+    double   min_probability_;              /**< Probability threshold */
+    bool     prune_;                        /**< Whether to prune */
+    size_t   table_mb_;                     /**< Table memory budget */
+    std::unique_ptr<ThreadPool> own_pool_;  /**< Threads of the player */
+    ThreadPool *pool_;                      /**< Threads, or null */
+    uint32_t searched_depth_;               /**< Depth of last play */
+    uint64_t nodes_;                        /**< Nodes visited by last play */
+    uint64_t cutoffs_;                      /**< Nodes cut off by last play */
+    uint64_t reused_;                       /**< Nodes reused by last play */
+    std::vector<std::unique_ptr<Table>> tables_;    /**< Table per thread */
+
+    /**
+     * Construct an ExpectimaxPlayer, with the arguments of the public
+     * constructors.
+     * @param pool the thread pool, or null to search on the calling thread
+     */
+    ExpectimaxPlayer(ThreadPool *pool, const eval::EvaluationFunction *eval,
+                     uint32_t depth, size_t table_mb, double min_probability,
+                     bool prune);
+
+    /**
+     * Choose a move on a game state of a specific type.
+     * @tparam State `BitBoard4x4` or `GameState`
+     * @param state the current game state
+     * @param max_depth the search depth
+     * @param range the range of the evaluation function within the search,
+     *      unbounded for no pruning
+     * @param limits the limits on the search
+     * @param move output the best move
+     * @return true if there is a legal move, false otherwise
+     */
+    template <typename State>
+    bool Search(State state, uint32_t max_depth,
+                const eval::EvaluationFunction::Range &range,
+                const SearchLimits &limits, GameState::Direction *move);
+
+    /**
+     * Create the transposition table of each thread.
+     */
+    void CreateTables();
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_EXPECTIMAXPLAYER_H_
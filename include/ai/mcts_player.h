@@ -0,0 +1,221 @@
+#ifndef _AI_MCTSPLAYER_H_
+#define _AI_MCTSPLAYER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "player.h"
+#include "ai/arena.h"
+
+namespace _2048 {
+namespace ai {
+
+class ThreadPool;
+
+/**
+ * A `Player` that searches with Monte Carlo tree search, playing the move
+ * tried most often at the root.
+ *
+ * The search stops after a number of playouts or at the time limit; the node
+ * limit of `SearchLimits` counts playouts, and the depth limit does not apply.
+ */
+class MctsPlayer : public Player {
+ public:
+    MctsPlayer(const MctsPlayer &) = delete;
+    MctsPlayer &operator=(const MctsPlayer &) = delete;
+
+    /**
+     * Construct an MctsPlayer.
+     * @param playouts the number of playouts for each move, or 0 for no limit
+     * @param time_limit the time for each move, or 0 for no limit
+     * @param threads the number of threads to search with, or 0 for one
+     *      thread per hardware thread of the machine
+     * @param seed the seed of the random playouts
+     * @param tree_mb the memory budget of the tree in megabytes
+     * @param exploration the UCT exploration constant, relative to the mean
+     *      score of the parent
+     * @throw std::invalid_argument if both `playouts` and `time_limit` are 0,
+     *      `tree_mb` is 0, or `exploration` is negative
+     */
+    explicit MctsPlayer(uint64_t playouts,
+                        std::chrono::milliseconds time_limit =
+                                std::chrono::milliseconds(0),
+                        uint32_t threads = 1, uint64_t seed = 0,
+                        size_t tree_mb = kDefaultTreeMB,
+                        double exploration = kDefaultExploration);
+
+    /**
+     * Construct an MctsPlayer that searches on a shared thread pool.
+     * @param playouts the number of playouts for each move, or 0 for no limit
+     * @param time_limit the time for each move, or 0 for no limit
+     * @param pool the thread pool, which must outlive the player
+     * @param seed the seed of the random playouts
+     * @param tree_mb the memory budget of the tree in megabytes
+     * @param exploration the UCT exploration constant, relative to the mean
+     *      score of the parent
+     * @throw std::invalid_argument if both `playouts` and `time_limit` are 0,
+     *      `tree_mb` is 0, or `exploration` is negative
+     */
+    MctsPlayer(uint64_t playouts, std::chrono::milliseconds time_limit,
+               ThreadPool &pool, uint64_t seed = 0,
+               size_t tree_mb = kDefaultTreeMB,
+               double exploration = kDefaultExploration);
+
+    /**
+     * Destructor
+     */
+    ~MctsPlayer() noexcept override;
+
+    /** Default memory budget of the tree in megabytes */
+    static constexpr size_t kDefaultTreeMB = 32;
+
+    /** Default UCT exploration constant */
+    static constexpr double kDefaultExploration = 1.0;
+
+    bool Play(const GameState &state, GameState::Direction *move) override;
+    bool Play(const GameState &state, GameState::Direction *move,
+              const SearchLimits &limits) override;
+
+    /**
+     * Get the number of threads the player searches with.
+     * @return the number of threads
+     */
+    uint32_t threads() const noexcept;
+
+    /**
+     * Get the number of playouts of the last `Play`.
+     * @return the number of completed iterations
+     */
+    uint64_t playouts() const noexcept { return playouts_; }
+
+    /**
+     * Get the number of tree nodes of the last `Play`.
+     * @return the number of nodes
+     */
+    size_t nodes() const noexcept { return tree_.size(); }
+
+    /**
+     * Get the number of tree nodes the last `Play` kept from the play before.
+     * @return the number of nodes
+     */
+    size_t reused() const noexcept { return reused_; }
+
+ private:
+    using Clock = SearchLimits::Clock;
+
+    /**
+     * A tree node, reached from its parent by a move or by a new tile.
+     */
+    struct Node {
+        std::atomic<uint32_t> visits;   /**< Iterations through the node,
+                                             including unfinished ones */
+        std::atomic<uint32_t> first;    /**< First child, or `kNone` */
+        std::atomic<uint64_t> score;    /**< Total score gained from the node
+                                             by finished iterations */
+        uint32_t next;                  /**< Next sibling, or `kNone` */
+        uint32_t key;                   /**< Move or new tile from parent */
+    };
+
+    /** Index of no node */
+    static constexpr uint32_t kNone = Arena<Node>::kNone;
+
+    uint64_t max_playouts_;                 /**< Playout budget, or 0 */
+    std::chrono::milliseconds time_limit_;  /**< Time budget, or 0 */
+    double   exploration_;                  /**< UCT exploration constant */
+    Arena<Node> tree_;                      /**< Nodes, the root first */
+    std::unique_ptr<ThreadPool> own_pool_;  /**< Threads of the player */
+    ThreadPool *pool_;                      /**< Threads, or null */
+    std::vector<std::default_random_engine> engines_;   /**< Engine per
+                                                             thread */
+    std::atomic<uint64_t> started_;         /**< Iterations started */
+    std::atomic<uint64_t> playouts_;        /**< Iterations finished */
+    std::unique_ptr<GameState> last_;       /**< State after the last move
+                                                 played, or null */
+    uint32_t last_node_;                    /**< Node of the last move
+                                                 played, or `kNone` */
+    size_t   reused_;                       /**< Nodes kept by last play */
+
+    /**
+     * Construct an MctsPlayer without random engines, with the arguments of
+     * the public constructors.
+     * @param pool the thread pool, or null to search on the calling thread
+     */
+    MctsPlayer(ThreadPool *pool, uint64_t playouts,
+               std::chrono::milliseconds time_limit, size_t tree_mb,
+               double exploration);
+
+    /**
+     * Create the random engine of each thread.
+     * @param seed the seed of the random playouts
+     */
+    void CreateEngines(uint64_t seed);
+
+    /**
+     * Make node 0 the root for a game state, keeping the subtree of the
+     * state if the last play reached it.
+     * @param state the current game state
+     */
+    void Root(const GameState &state);
+
+    /**
+     * Move the subtree of a node to the front of the arena, with the node
+     * first, and free the other nodes.
+     * @param node the root of the subtree
+     */
+    void Keep(uint32_t node);
+
+    /**
+     * Choose a move on a game state of a specific type.
+     * @tparam State `BitBoard4x4` or `GameState`
+     * @param state the current game state
+     * @param limits the limits on top of those of the player
+     * @param move output the most visited move
+     * @return the node of the move, or `kNone` if no iteration tried a move
+     */
+    template <typename State>
+    uint32_t Search(const State &state, const SearchLimits &limits,
+                GameState::Direction *move);
+
+    /**
+     * Run iterations until the budget is spent.
+     * @tparam State `BitBoard4x4` or `GameState`
+     * @param root the current game state
+     * @param engine the random engine of the thread
+     * @param limits the limits of all threads, with playouts as nodes
+     */
+    template <typename State>
+    void Iterate(const State &root, std::default_random_engine *engine,
+                 const SearchLimits &limits);
+
+    /**
+     * Choose the move to try at a position by UCT. An untried legal move is
+     * added to the tree and chosen first.
+     * @param parent the node of the position
+     * @param mask the legal moves of the position
+     * @param added output whether the returned node is new
+     * @return the node of the move, or `kNone` if the tree is full
+     */
+    uint32_t Select(uint32_t parent, GameState::DirectionMask mask,
+                    bool *added);
+
+    /**
+     * Find the child of a node with a key, or add it. Safe to call from
+     * several threads at once.
+     * @param parent the parent node
+     * @param key the key of the child
+     * @param added output whether the returned node is new
+     * @return the child, or `kNone` if it is not in the tree and the tree is
+     *      full
+     */
+    uint32_t Child(uint32_t parent, uint32_t key, bool *added);
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_MCTSPLAYER_H_
@@ -0,0 +1,123 @@
+#ifndef _AI_MINIMAXPLAYER_H_
+#define _AI_MINIMAXPLAYER_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <chrono>
+
+#include "player.h"
+#include "ai/eval/eval_func.h"
+#include "ai/transposition_table.h"
+
+namespace _2048 {
+namespace ai {
+
+/**
+ * A `Player` that searches with alpha-beta minimax, treating the generator as
+ * an adversary that adds the worst 2 or 4 for the player.
+ *
+ * The search deepens one move at a time up to the maximum depth, and plays
+ * the last complete iteration when the time limit or `SearchLimits` stop it.
+ */
+class MinimaxPlayer : public Player {
+ public:
+    MinimaxPlayer(const MinimaxPlayer &) = delete;
+    MinimaxPlayer &operator=(const MinimaxPlayer &) = delete;
+
+    /**
+     * Construct a MinimaxPlayer.
+     * @param eval the evaluation function, which must outlive the player
+     * @param max_depth the maximum number of player moves to look ahead,
+     *      including the move being chosen
+     * @param time_limit the time for each move, or 0 for no limit
+     * @param table_mb the memory budget of the transposition table in
+     *      megabytes
+     * @throw std::invalid_argument if `eval` is null, or `max_depth` is 0 or
+     *      greater than `kMaxDepth`
+     */
+    MinimaxPlayer(const eval::EvaluationFunction *eval, uint32_t max_depth,
+                  std::chrono::milliseconds time_limit =
+                          std::chrono::milliseconds(0),
+                  size_t table_mb = kDefaultTableMB);
+
+    /** Maximum search depth, limited by the depth stored in the table */
+    static constexpr uint32_t kMaxDepth = 255;
+
+    /** Default memory budget of the transposition table in megabytes */
+    static constexpr size_t kDefaultTableMB = 16;
+
+    /** Type of the transposition table */
+    using Table = TranspositionTable<int64_t>;
+
+    bool Play(const GameState &state, GameState::Direction *move) override;
+    bool Play(const GameState &state, GameState::Direction *move,
+              const SearchLimits &limits) override;
+
+    /**
+     * Get the depth of the last completed iteration of the last `Play`.
+     * @return the depth in player moves
+     */
+    uint32_t depth() const noexcept { return depth_; }
+
+    /**
+     * Get the minimax value of the move chosen by the last `Play`.
+     * @return the value, from the last completed iteration
+     */
+    int64_t value() const noexcept { return value_; }
+
+    /**
+     * Get the number of nodes visited by the last `Play`, including the
+     * nodes of an interrupted iteration.
+     * @return the number of player and generator nodes
+     */
+    uint64_t nodes() const noexcept { return nodes_; }
+
+    /**
+     * Get the number of table hits of the last `Play` on results stored by
+     * earlier plays.
+     * @return the number of reused nodes
+     */
+    uint64_t reused() const noexcept { return reused_; }
+
+    /**
+     * Get the search speed of the last `Play`.
+     * @return nodes per second, or 0 if nothing was searched
+     */
+    double NodesPerSecond() const noexcept {
+        return seconds_ > 0 ? nodes_ / seconds_ : 0;
+    }
+
+    /**
+     * Get the transposition table, for its counters.
+     * @return the table
+     */
+    const Table &table() const noexcept { return table_; }
+
+ private:
+    const eval::EvaluationFunction *eval_;  /**< Evaluation function */
+    uint32_t max_depth_;                    /**< Maximum search depth */
+    std::chrono::milliseconds time_limit_;  /**< Time for each move */
+    Table    table_;                        /**< Transposition table */
+    uint32_t depth_;                        /**< Depth of last play */
+    int64_t  value_;                        /**< Value of last play */
+    uint64_t nodes_;                        /**< Nodes visited by last play */
+    uint64_t reused_;                       /**< Nodes reused by last play */
+    double   seconds_;                      /**< Duration of last play */
+
+    /**
+     * Choose a move on a game state of a specific type.
+     * @tparam State `BitBoard4x4` or `GameState`
+     * @param state the current game state
+     * @param limits the limits on top of those of the player
+     * @param move output the best move
+     * @return true if there is a legal move, false otherwise
+     */
+    template <typename State>
+    bool Search(State state, const SearchLimits &limits,
+                GameState::Direction *move);
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_MINIMAXPLAYER_H_
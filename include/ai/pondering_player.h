@@ -0,0 +1,110 @@
+#ifndef _AI_PONDERINGPLAYER_H_
+#define _AI_PONDERINGPLAYER_H_
+
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "player.h"
+
+namespace _2048 {
+namespace ai {
+
+/**
+ * A `Player` that lets another player think during the generator's turn.
+ *
+ * After every move, a background thread asks the other player for its move
+ * on each state the generator may create, 2s before 4s, and keeps the
+ * answers. When `Play` is then called for one of those states, the kept
+ * answer is returned at once. Otherwise the background thread is stopped,
+ * through `SearchLimits::stop`, and the other player searches as usual; a
+ * search player that keeps a transposition table across moves still finds
+ * the positions pondered so far in it.
+ *
+ * The other player is only used by one thread at a time, so it need not be
+ * thread-safe, but its counters are those of its last search, which may be
+ * a pondering one. An exception thrown by the other player while pondering
+ * ends pondering for that move.
+ */
+class PonderingPlayer : public Player {
+ public:
+    PonderingPlayer(const PonderingPlayer &) = delete;
+    PonderingPlayer &operator=(const PonderingPlayer &) = delete;
+
+    /**
+     * Construct a PonderingPlayer.
+     * @param player the player that searches, which must outlive this player
+     * @throw std::invalid_argument if `player` is null
+     */
+    explicit PonderingPlayer(Player *player);
+
+    /**
+     * Destructor
+     * Stops pondering.
+     */
+    ~PonderingPlayer() noexcept override;
+
+    bool Play(const GameState &state, GameState::Direction *move) override;
+
+    /**
+     * Play a move within search limits.
+     * A pondered answer is used only if `limits` has no node or depth limit.
+     * @param state the current game state
+     * @param move output the direction of the next move
+     * @param limits the limits on the search
+     * @return true if successful, otherwise false
+     */
+    bool Play(const GameState &state, GameState::Direction *move,
+              const SearchLimits &limits) override;
+
+    /**
+     * Stop pondering, and wait for the background thread to finish.
+     */
+    void Stop() noexcept;
+
+    /**
+     * Wait until every state after the last move is pondered.
+     */
+    void Wait() noexcept;
+
+    /**
+     * Get the number of plays answered by pondering.
+     * @return the number of plays
+     */
+    uint64_t hits() const noexcept { return hits_; }
+
+    /**
+     * Get the number of plays that had to search.
+     * @return the number of plays
+     */
+    uint64_t misses() const noexcept { return misses_; }
+
+ private:
+    /**
+     * The answer of the other player for a state.
+     */
+    struct Answer {
+        GameState state;                /**< State after the new tile */
+        bool      played;               /**< Whether there was a move */
+        GameState::Direction move;      /**< The move */
+    };
+
+    Player  *player_;                   /**< Player that searches */
+    std::thread thread_;                /**< Pondering thread */
+    std::atomic<bool> stop_;            /**< Whether to stop pondering */
+    std::vector<Answer> answers_;       /**< Answers found by pondering */
+    uint64_t hits_;                     /**< Plays answered by pondering */
+    uint64_t misses_;                   /**< Plays that had to search */
+
+    /**
+     * Body of the pondering thread.
+     * @param after the state after the last move, before the new tile
+     */
+    void Ponder(GameState after);
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_PONDERINGPLAYER_H_
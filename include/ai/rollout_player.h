@@ -0,0 +1,127 @@
+#ifndef _AI_ROLLOUTPLAYER_H_
+#define _AI_ROLLOUTPLAYER_H_
+
+#include <cstdint>
+#include <memory>
+
+#include "player.h"
+
+namespace _2048 {
+namespace ai {
+
+class ThreadPool;
+
+/**
+ * A `Player` that plays the move with the best random games after it, a flat
+ * Monte Carlo baseline.
+ *
+ * The chosen move does not depend on the number of threads. The node limit of
+ * `SearchLimits` caps the number of games, and the depth limit does not apply.
+ */
+class RolloutPlayer : public Player {
+ public:
+    RolloutPlayer(const RolloutPlayer &) = delete;
+    RolloutPlayer &operator=(const RolloutPlayer &) = delete;
+
+    /**
+     * What the player maximizes.
+     */
+    enum class Objective { SCORE, MOVES };
+
+    /**
+     * Construct a RolloutPlayer.
+     * @param rollouts the number of random games for each legal move
+     * @param objective what the mean of the games measures
+     * @param threads the number of threads to play with, or 0 for one thread
+     *      per hardware thread of the machine
+     * @param seed the seed of the random games
+     * @throw std::invalid_argument if `rollouts` is 0
+     */
+    explicit RolloutPlayer(uint32_t rollouts,
+                           Objective objective = Objective::SCORE,
+                           uint32_t threads = 1, uint64_t seed = 0);
+
+    /**
+     * Construct a RolloutPlayer that plays on a shared thread pool.
+     * @param rollouts the number of random games for each legal move
+     * @param objective what the mean of the games measures
+     * @param pool the thread pool, which must outlive the player
+     * @param seed the seed of the random games
+     * @throw std::invalid_argument if `rollouts` is 0
+     */
+    RolloutPlayer(uint32_t rollouts, Objective objective, ThreadPool &pool,
+                  uint64_t seed = 0);
+
+    /**
+     * Destructor
+     */
+    ~RolloutPlayer() noexcept override;
+
+    /** Number of random games in a batch, which runs on one thread */
+    static constexpr uint32_t kBatch = 64;
+
+    bool Play(const GameState &state, GameState::Direction *move) override;
+    bool Play(const GameState &state, GameState::Direction *move,
+              const SearchLimits &limits) override;
+
+    /**
+     * Get the number of threads the player plays with.
+     * @return the number of threads
+     */
+    uint32_t threads() const noexcept;
+
+    /**
+     * Get the number of random games played by the last `Play`.
+     * @return the number of games
+     */
+    uint64_t rollouts() const noexcept { return rollouts_; }
+
+    /**
+     * Get the number of moves of the random games of the last `Play`.
+     * @return the number of moves
+     */
+    uint64_t moves() const noexcept { return moves_; }
+
+    /**
+     * Get the speed of the random games of the last `Play`.
+     * @return moves per second, or 0 if nothing was played
+     */
+    double MovesPerSecond() const noexcept {
+        return seconds_ > 0 ? moves_ / seconds_ : 0;
+    }
+
+ private:
+    uint32_t max_rollouts_;                 /**< Games for each move */
+    Objective objective_;                   /**< What the games measure */
+    uint64_t seed_;                         /**< Seed of the games */
+    std::unique_ptr<ThreadPool> own_pool_;  /**< Threads of the player */
+    ThreadPool *pool_;                      /**< Threads, or null */
+    uint64_t plays_;                        /**< Number of plays */
+    uint64_t rollouts_;                     /**< Games of last play */
+    uint64_t moves_;                        /**< Moves of last play */
+    double   seconds_;                      /**< Duration of last play */
+
+    /**
+     * Construct a RolloutPlayer, with the arguments of the public
+     * constructors.
+     * @param pool the thread pool, or null to play on the calling thread
+     */
+    RolloutPlayer(ThreadPool *pool, uint32_t rollouts, Objective objective,
+                  uint64_t seed);
+
+    /**
+     * Choose a move on a game state of a specific type.
+     * @tparam State `BitBoard4x4` or `GameState`
+     * @param state the current game state, with a legal move
+     * @param limits the limits on the games
+     * @return the move with the best games
+     */
+    template <typename State>
+    GameState::Direction Search(const State &state,
+                                const SearchLimits &limits);
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_ROLLOUTPLAYER_H_
@@ -0,0 +1,71 @@
+#ifndef _AI_TABLEPLAYER_H_
+#define _AI_TABLEPLAYER_H_
+
+#include <string>
+
+#include "player.h"
+#include "ai/value_table.h"
+
+namespace _2048 {
+namespace ai {
+
+/**
+ * A `Player` that plays perfectly on a small board, by the values that a
+ * `Solver` wrote to a table file.
+ *
+ * Every move looks up the position after each legal move in the mapped
+ * `ValueTable`, with one binary search each, and plays the move with the most
+ * moves or score to come, counting the move itself; ties go to the first
+ * move in `kDirections` order. The player does not search, so it ignores the
+ * limits of `Play`.
+ */
+class TablePlayer : public Player {
+ public:
+    TablePlayer(const TablePlayer &) = delete;
+    TablePlayer &operator=(const TablePlayer &) = delete;
+
+    /**
+     * Construct a TablePlayer.
+     * @param path the path of the table file
+     * @throw std::runtime_error if the file cannot be mapped, or is not a
+     *      valid table
+     */
+    explicit TablePlayer(const std::string &path);
+
+    /**
+     * Play the best move.
+     * If failed, `*move` will stay unmodified.
+     * @param state the current game state
+     * @param move output the direction of the next move
+     * @return true if successful, otherwise false
+     * @throw std::invalid_argument if `state` is not of the size of the table
+     * @throw std::out_of_range if a position after a move is not in the table,
+     *      which only happens if `state` cannot be reached from a board with
+     *      one or two tiles
+     * @throw std::runtime_error if `state` is not valid
+     */
+    bool Play(const GameState &state, GameState::Direction *move) override;
+
+    /**
+     * Get the table of the player.
+     * @return the table
+     */
+    const ValueTable &table() const noexcept { return table_; }
+
+    /**
+     * Get the value of the state of the last `Play` under perfect play: the
+     * expected number of moves or score from it on.
+     * @return the value, or 0 if there was no legal move
+     */
+    double value() const noexcept { return value_; }
+
+ private:
+    ValueTable table_;  /**< Values of the positions after a move */
+    TableKeys keys_;    /**< Keys of the positions */
+    double value_;      /**< Value of the last state */
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_TABLEPLAYER_H_
@@ -0,0 +1,149 @@
+#ifndef _AI_THREADPOOL_H_
+#define _AI_THREADPOOL_H_
+
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <deque>
+#include <vector>
+
+namespace _2048 {
+namespace ai {
+
+/**
+ * A fixed set of threads that run numbered tasks in parallel, with work
+ * stealing.
+ *
+ * Every thread has a deque of tasks. A thread runs the newest task of its own
+ * deque, and when the deque is empty, it steals the older half of the tasks
+ * of another thread. A task may call `Run` itself to split its work further;
+ * while it waits, its thread keeps running other tasks, so all threads stay
+ * busy however unbalanced the tasks are. The pool can be shared by any
+ * number of searches and simulations.
+ *
+ * A thread outside the pool that calls `Run` works on the tasks too, as
+ * thread 0, so a pool of size n has n - 1 background threads, and a pool of
+ * size 1 runs everything on the calling thread. Calls from outside the pool
+ * are serialized.
+ */
+class ThreadPool {
+ public:
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * Construct a ThreadPool.
+     * @param size the number of threads, or 0 for one thread per hardware
+     *      thread of the machine
+     */
+    explicit ThreadPool(uint32_t size);
+
+    /**
+     * Destructor
+     * Stops the background threads.
+     */
+    ~ThreadPool() noexcept;
+
+    /**
+     * Get the number of threads, including the calling thread.
+     * @return the number of threads
+     */
+    uint32_t size() const noexcept { return deques_.size(); }
+
+    /**
+     * Get the index of the calling thread.
+     * @return the index in [0, `size()`) of the calling thread if it is
+     *      running a task of this pool, 0 otherwise
+     */
+    uint32_t CurrentThread() const noexcept;
+
+    /**
+     * Run tasks `0` to `count - 1` and wait for all of them. Each task runs
+     * once, on any thread, in no particular order.
+     * @param count the number of tasks
+     * @param task the task body, called with the index of the thread in
+     *      [0, `size()`) and the index of the task
+     * @throw the first exception thrown by a task, after all tasks are done
+     */
+    void Run(uint32_t count,
+             const std::function<void(uint32_t, uint32_t)> &task);
+
+ private:
+    /**
+     * The tasks of one call of `Run`.
+     */
+    struct Group {
+        const std::function<void(uint32_t, uint32_t)> *body;  /**< Body */
+        std::atomic<uint32_t> pending;  /**< Tasks not finished */
+        std::mutex mutex;               /**< Guards `error` */
+        std::exception_ptr error;       /**< First exception */
+    };
+
+    /**
+     * A task waiting to run.
+     */
+    struct Task {
+        Group   *group;     /**< Group of the task */
+        uint32_t index;     /**< Index of the task */
+    };
+
+    /**
+     * The tasks of one thread, on a cache line of its own.
+     */
+    struct alignas(64) Deque {
+        std::mutex mutex;           /**< Guards `tasks` */
+        std::deque<Task> tasks;     /**< Oldest first */
+    };
+
+    std::vector<std::unique_ptr<Deque>> deques_;    /**< Deque per thread */
+    std::vector<std::thread> threads_;      /**< Background threads */
+    std::mutex external_;                   /**< Serializes outside calls */
+    std::mutex sleep_mutex_;                /**< Guards sleeping */
+    std::condition_variable wake_;          /**< Signals new tasks */
+    std::atomic<uint64_t> queued_;          /**< Tasks in all deques */
+    std::atomic<bool> stop_;                /**< Whether threads should exit */
+
+    static thread_local const ThreadPool *current_pool_;  /**< Pool of the
+                                                               thread */
+    static thread_local uint32_t current_index_;    /**< Index of the thread */
+
+    /**
+     * Push the tasks of a group and run tasks until the group is done.
+     * @param count the number of tasks
+     * @param group the group
+     * @param index the index of the calling thread
+     */
+    void RunGroup(uint32_t count, Group *group, uint32_t index);
+
+    /**
+     * Run one task, from the own deque or stolen from another thread.
+     * @param index the index of the calling thread
+     * @return true if a task was run, false if no task was found
+     */
+    bool RunOne(uint32_t index);
+
+    /**
+     * Steal the older half of the tasks of another thread, keeping all but
+     * one in the own deque.
+     * @param index the index of the calling thread
+     * @param task output the task to run
+     * @return true if a task was stolen, false otherwise
+     */
+    bool Steal(uint32_t index, Task *task);
+
+    /**
+     * Body of a background thread.
+     * @param index the index of the thread
+     */
+    void Work(uint32_t index);
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_THREADPOOL_H_
@@ -0,0 +1,252 @@
+#ifndef _AI_TRANSPOSITIONTABLE_H_
+#define _AI_TRANSPOSITIONTABLE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <type_traits>
+
+namespace _2048 {
+namespace ai {
+
+/**
+ * A fixed-size hash table of search results, keyed by 64-bit board hashes.
+ *
+ * The table is an array of 64-byte buckets, one cache line each, holding 4
+ * entries. The low bits of a key choose the bucket, and the high 32 bits are
+ * kept in the entry to tell positions apart. When a bucket is full, the
+ * shallowest entry is replaced, and entries left by earlier searches (see
+ * `NewSearch`) are replaced first.
+ * @tparam Value the type of the search values, 8 bytes at most
+ */
+template <typename Value>
+class TranspositionTable {
+    static_assert(sizeof(Value) <= 8 &&
+                          std::is_trivially_copyable<Value>::value,
+                  "value does not fit in an entry");
+
+ public:
+    /**
+     * How a stored value relates to the true value of the position.
+     */
+    enum class Bound : uint8_t { NONE, EXACT, LOWER, UPPER };
+
+    /** Stored best child when there is none */
+    static constexpr uint8_t kNoMove = 0xFF;
+
+    /**
+     * A search result.
+     */
+    struct Entry {
+        Value    value;     /**< Value of the position */
+        uint8_t  depth;     /**< Depth the value was searched to */
+        Bound    bound;     /**< Kind of the value */
+        uint8_t  move;      /**< Index of the best child, or `kNoMove` */
+    };
+
+    /**
+     * Counters of table operations.
+     */
+    struct Stats {
+        uint64_t hits;          /**< Probes that found their key */
+        uint64_t reused;        /**< Hits on entries of earlier searches */
+        uint64_t misses;        /**< Probes that did not find their key */
+        uint64_t stores;        /**< Stores */
+        uint64_t collisions;    /**< Stores that evicted another position of
+                                     the current search */
+    };
+
+    /**
+     * Construct a table.
+     * @param megabytes the memory budget; the table takes the largest power of
+     *      2 number of buckets that fits, and at least one bucket
+     */
+    explicit TranspositionTable(size_t megabytes)
+            : buckets_(BucketCount(megabytes)),
+              mask_(buckets_.size() - 1),
+              generation_(0),
+              stats_() { }
+
+    /**
+     * Get the memory used by the entries.
+     * @return the size in bytes
+     */
+    size_t bytes() const noexcept { return buckets_.size() * sizeof(Bucket); }
+
+    /**
+     * Get the number of entries the table can hold.
+     * @return the capacity
+     */
+    size_t capacity() const noexcept { return buckets_.size() * kWays; }
+
+    /**
+     * Get the counters since construction or the last `ResetStats`.
+     * @return the counters
+     */
+    const Stats &stats() const noexcept { return stats_; }
+
+    /**
+     * Reset the counters.
+     */
+    void ResetStats() noexcept { stats_ = Stats(); }
+
+    /**
+     * Mark the entries stored so far as belonging to an earlier search, so
+     * they are replaced before the entries of the new search. The entries can
+     * still be found.
+     * Entries are told apart by their age in searches, which wraps around
+     * after 256 searches, so every 128 searches the entries older than 127
+     * searches are made 127 searches old.
+     */
+    void NewSearch() noexcept {
+        if (++generation_ % 128 == 0)
+            CapAges();
+    }
+
+    /**
+     * Remove all entries.
+     */
+    void Clear() noexcept {
+        for (Bucket &bucket : buckets_)
+            bucket = Bucket();
+    }
+
+    /**
+     * Look up a position.
+     * @param key the hash of the position
+     * @param entry output the stored result if found
+     * @param earlier output whether the result was stored by an earlier
+     *      search, if found, or null
+     * @return true if the position is found, false otherwise
+     */
+    bool Probe(uint64_t key, Entry *entry, bool *earlier = nullptr) noexcept {
+        Bucket &bucket = buckets_[key & mask_];
+        const uint32_t check = key >> 32;
+        for (Slot &slot : bucket.slots)
+            if (slot.bound != Bound::NONE && slot.check == check) {
+                *entry = Entry{slot.value, slot.depth, slot.bound, slot.move};
+                stats_.hits++;
+                if (Age(slot) != 0)
+                    stats_.reused++;
+                if (earlier != nullptr)
+                    *earlier = Age(slot) != 0;
+                return true;
+            }
+        stats_.misses++;
+        return false;
+    }
+
+    /**
+     * Store a search result.
+     * A result for a position already in the table replaces the old one
+     * unless the old one is deeper and from the current search.
+     * @param key the hash of the position
+     * @param entry the result, whose bound must not be `Bound::NONE`
+     */
+    void Store(uint64_t key, const Entry &entry) noexcept {
+        Bucket &bucket = buckets_[key & mask_];
+        const uint32_t check = key >> 32;
+        stats_.stores++;
+
+        // the same position, or else the least valuable slot
+        Slot *victim = &bucket.slots[0];
+        for (Slot &slot : bucket.slots) {
+            if (slot.bound != Bound::NONE && slot.check == check) {
+                if (Age(slot) == 0 && slot.depth > entry.depth)
+                    return;
+                victim = &slot;
+                break;
+            }
+            if (Priority(slot) < Priority(*victim))
+                victim = &slot;
+        }
+        if (victim->bound != Bound::NONE && victim->check != check &&
+                Age(*victim) == 0)
+            stats_.collisions++;
+
+        victim->value = entry.value;
+        victim->check = check;
+        victim->depth = entry.depth;
+        victim->bound = entry.bound;
+        victim->move = entry.move;
+        victim->generation = generation_;
+    }
+
+ private:
+    static constexpr size_t kWays = 4;  /**< Entries per bucket */
+
+    /**
+     * An entry as stored, 16 bytes.
+     */
+    struct Slot {
+        Value    value = Value();       /**< Value of the position */
+        uint32_t check = 0;             /**< High 32 bits of the key */
+        uint8_t  depth = 0;             /**< Depth of the value */
+        Bound    bound = Bound::NONE;   /**< Kind of value, NONE if unused */
+        uint8_t  move = kNoMove;        /**< Best child */
+        uint8_t  generation = 0;        /**< Search that stored the entry */
+    };
+
+    /**
+     * One cache line of slots.
+     */
+    struct alignas(64) Bucket {
+        Slot slots[kWays];
+    };
+
+    static_assert(sizeof(Bucket) == 64, "bucket is not a cache line");
+
+    std::vector<Bucket> buckets_;   /**< Buckets */
+    size_t   mask_;                 /**< Number of buckets - 1 */
+    uint8_t  generation_;           /**< Current search */
+    Stats    stats_;                /**< Counters */
+
+    /**
+     * Rank a slot for replacement; the lowest rank is replaced first.
+     * @param slot the slot
+     * @return the rank
+     */
+    int32_t Priority(const Slot &slot) const noexcept {
+        if (slot.bound == Bound::NONE)
+            return -1;
+        return (Age(slot) == 0 ? 256 : 0) + slot.depth;
+    }
+
+    /**
+     * Get the number of searches since a slot was stored.
+     * @param slot the slot
+     * @return the age, 0 for the current search
+     */
+    uint8_t Age(const Slot &slot) const noexcept {
+        return static_cast<uint8_t>(generation_ - slot.generation);
+    }
+
+    /**
+     * Make the slots older than 127 searches 127 searches old, so that the
+     * age of no slot wraps around to 0 in the next 128 searches.
+     */
+    void CapAges() noexcept {
+        for (Bucket &bucket : buckets_)
+            for (Slot &slot : bucket.slots)
+                if (slot.bound != Bound::NONE && Age(slot) > 127)
+                    slot.generation = static_cast<uint8_t>(generation_ - 127);
+    }
+
+    /**
+     * Compute the number of buckets for a memory budget.
+     * @param megabytes the memory budget
+     * @return the largest power of 2 that fits, at least 1
+     */
+    static size_t BucketCount(size_t megabytes) noexcept {
+        const size_t budget = megabytes * 1024 * 1024 / sizeof(Bucket);
+        size_t count = 1;
+        while (count * 2 <= budget)
+            count *= 2;
+        return count;
+    }
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_TRANSPOSITIONTABLE_H_
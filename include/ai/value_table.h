@@ -0,0 +1,175 @@
+#ifndef _AI_VALUETABLE_H_
+#define _AI_VALUETABLE_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "game_state.h"
+
+namespace _2048 {
+namespace ai {
+
+/**
+ * Packs the game states of one size into the keys of a `ValueTable`.
+ *
+ * A key holds the power of tile i, in row-major order, in bits 4i to 4i + 3.
+ * The canonical key of a state is the smallest key of its symmetric copies:
+ * the 8 rotations and reflections of a square board, or the 4 reflections of
+ * any other board. Symmetric states have the same values, so a table only
+ * keeps canonical keys.
+ */
+class TableKeys {
+ public:
+    /** Maximum number of tiles of a board */
+    static constexpr uint32_t kMaxTiles = 16;
+
+    /** Maximum power of a tile */
+    static constexpr uint8_t kMaxPower = 15;
+
+    /**
+     * Construct the keys of a board size.
+     * @param height the number of rows
+     * @param width the number of cols
+     * @throw std::invalid_argument if the board is empty, or has more than
+     *      `kMaxTiles` tiles
+     */
+    TableKeys(uint32_t height, uint32_t width);
+
+    /**
+     * Get the number of rows.
+     * @return the height
+     */
+    uint32_t height() const noexcept { return height_; }
+
+    /**
+     * Get the number of cols.
+     * @return the width
+     */
+    uint32_t width() const noexcept { return width_; }
+
+    /**
+     * Pack a game state.
+     * @param state the game state
+     * @return the key of the state, which may not be canonical
+     * @throw std::invalid_argument if `state` is of another size, or has a
+     *      power greater than `kMaxPower`
+     * @throw std::runtime_error if `state` is not valid
+     */
+    uint64_t Pack(const GameState &state) const;
+
+    /**
+     * Find the canonical key of a state.
+     * @param key the key of the state
+     * @return the smallest key of the symmetric copies of the state
+     */
+    uint64_t Canonical(uint64_t key) const noexcept;
+
+ private:
+    uint32_t height_;   /**< Number of rows */
+    uint32_t width_;    /**< Number of cols */
+
+    /** Tile that each tile goes to, under each symmetry but the identity */
+    std::vector<std::vector<uint8_t>> maps_;
+};
+
+/**
+ * A read-only table of the values of game states of one size, mapped from a
+ * file.
+ *
+ * The file has a header with the board size and the objective, then the
+ * sorted canonical keys of the states, then their values in the same order,
+ * all in the byte order of the machine that wrote it. The file is mapped
+ * into memory rather than read, so opening a large table is instant and its
+ * pages are shared by all processes that use it; a lookup is a binary search
+ * over the keys.
+ */
+class ValueTable {
+ public:
+    ValueTable(const ValueTable &) = delete;
+    ValueTable &operator=(const ValueTable &) = delete;
+
+    /**
+     * What the values measure.
+     */
+    enum class Objective : uint8_t { MOVES, SCORE };
+
+    /**
+     * Map a table file.
+     * @param path the path of the file
+     * @throw std::runtime_error if the file cannot be mapped, or is not a
+     *      valid table
+     */
+    explicit ValueTable(const std::string &path);
+
+    /**
+     * Destructor
+     * Unmaps the file.
+     */
+    ~ValueTable() noexcept;
+
+    /**
+     * Get the number of rows of the boards.
+     * @return the height
+     */
+    uint32_t height() const noexcept { return height_; }
+
+    /**
+     * Get the number of cols of the boards.
+     * @return the width
+     */
+    uint32_t width() const noexcept { return width_; }
+
+    /**
+     * Get what the values measure.
+     * @return the objective
+     */
+    Objective objective() const noexcept { return objective_; }
+
+    /**
+     * Get the number of states in the table.
+     * @return the number of states
+     */
+    uint64_t size() const noexcept { return size_; }
+
+    /**
+     * Look up the value of a state.
+     * @param key the canonical key of the state
+     * @param value output the value of the state
+     * @return true if the state is in the table, otherwise false
+     */
+    bool Find(uint64_t key, double *value) const noexcept;
+
+    /**
+     * Write a table file.
+     * @param path the path of the file
+     * @param height the number of rows of the boards
+     * @param width the number of cols of the boards
+     * @param objective what the values measure
+     * @param keys the canonical keys of the states, in increasing order
+     * @param values the values of the states
+     * @throw std::invalid_argument if the keys are not increasing, or there
+     *      is not one value for each key
+     * @throw std::runtime_error if the file cannot be written
+     */
+    static void Write(const std::string &path, uint32_t height,
+                      uint32_t width, Objective objective,
+                      const std::vector<uint64_t> &keys,
+                      const std::vector<double> &values);
+
+ private:
+    void *data_;                /**< Mapped file */
+    size_t length_;             /**< Length of the file */
+    uint32_t height_;           /**< Number of rows */
+    uint32_t width_;            /**< Number of cols */
+    Objective objective_;       /**< What the values measure */
+    uint64_t size_;             /**< Number of states */
+    const uint64_t *keys_;      /**< Sorted keys */
+    const double *values_;      /**< Values of the keys */
+};
+
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _AI_VALUETABLE_H_
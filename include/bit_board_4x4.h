@@ -0,0 +1,333 @@
+#ifndef _BITBOARD4X4_H_
+#define _BITBOARD4X4_H_
+
+#include <cstdint>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+#include "tile.h"
+#include "game_state.h"
+
+namespace _2048 {
+
+/**
+ * A 4 by 4 game state packed into a single 64-bit integer.
+ *
+ * Each tile takes 4 bits holding its power, so the largest representable tile
+ * is 2^15. The tile at row `r` and col `c` is stored in the 4 bits starting at
+ * bit `16 * r + 4 * c`. The operations behave exactly like the ones of a
+ * 4 by 4 `GameState`.
+ */
+class BitBoard4x4 {
+ public:
+    using Position  = GameState::Position;
+    using Direction = GameState::Direction;
+    using DirectionMask = GameState::DirectionMask;
+    using MoveResult = GameState::MoveResult;
+
+    static constexpr uint32_t kHeight   = 4;    /**< Board height */
+    static constexpr uint32_t kWidth    = 4;    /**< Board width */
+    static constexpr uint8_t  kMaxPower = 15;   /**< Largest tile power */
+
+    /**
+     * A record of a move or a tile generation, enough to undo it exactly.
+     * It is the board before the operation.
+     */
+    class UndoRecord {
+     public:
+        /**
+         * Construct an empty record.
+         */
+        constexpr UndoRecord() noexcept : board_(0), valid_(false) { }
+
+     private:
+        friend class BitBoard4x4;
+        uint64_t board_;    /**< Board before the operation */
+        bool     valid_;    /**< Whether an operation is recorded */
+    };
+
+    /**
+     * Construct an empty board.
+     */
+    constexpr BitBoard4x4() noexcept : board_(0) { }
+
+    /**
+     * Construct a board from its packed representation.
+     * @param board the packed board
+     */
+    explicit constexpr BitBoard4x4(uint64_t board) noexcept : board_(board) { }
+
+    /**
+     * Construct a board from a `GameState`.
+     * @param state the game state
+     * @throw std::invalid_argument if `state` is not 4 by 4 or contains a tile
+     *      larger than 2^15
+     * @throw std::runtime_error if `state` is not in a valid state
+     */
+    explicit BitBoard4x4(const GameState &state);
+
+    /**
+     * Convert this board into a `GameState`.
+     * @return a 4 by 4 `GameState` with the same tiles
+     */
+    GameState ToGameState() const;
+
+    /**
+     * Get the packed representation.
+     * @return the packed board
+     */
+    constexpr uint64_t raw() const noexcept { return board_; }
+
+    /**
+     * Get game grid height.
+     * @return the height
+     */
+    constexpr uint32_t height() const noexcept { return kHeight; }
+
+    /**
+     * Get game grid width.
+     * @return the width
+     */
+    constexpr uint32_t width() const noexcept { return kWidth; }
+
+    /**
+     * Equality
+     * @param b the other `BitBoard4x4` object
+     * @return true if the two boards are identical, false otherwise
+     */
+    constexpr bool operator==(const BitBoard4x4 &b) const noexcept {
+        return board_ == b.board_;
+    }
+
+    /**
+     * Inequality
+     * @param b the other `BitBoard4x4` object
+     * @return false if the two boards are identical, true otherwise
+     */
+    constexpr bool operator!=(const BitBoard4x4 &b) const noexcept {
+        return board_ != b.board_;
+    }
+
+    /**
+     * Swap rows and cols, in a few bit operations.
+     * @return the board mirrored along its main diagonal
+     */
+    constexpr BitBoard4x4 Transpose() const noexcept {
+        // swap the 2x2 blocks first, then the tiles within each block
+        uint64_t a = (board_ & 0xF0F00F0FF0F00F0Full) |
+                     (board_ & 0x0000F0F00000F0F0ull) << 12 |
+                     (board_ & 0x0F0F00000F0F0000ull) >> 12;
+        return BitBoard4x4((a & 0xFF00FF0000FF00FFull) |
+                           (a & 0x00FF00FF00000000ull) >> 24 |
+                           (a & 0x00000000FF00FF00ull) << 24);
+    }
+
+    /**
+     * Reverse the order of the rows.
+     * @return the board upside down
+     */
+    constexpr BitBoard4x4 MirrorRows() const noexcept {
+        return BitBoard4x4(board_ >> 48 |
+                           (board_ >> 16 & 0x00000000FFFF0000ull) |
+                           (board_ << 16 & 0x0000FFFF00000000ull) |
+                           board_ << 48);
+    }
+
+    /**
+     * Reverse the order of the cols.
+     * @return the board mirrored left to right
+     */
+    constexpr BitBoard4x4 MirrorCols() const noexcept {
+        uint64_t a = (board_ & 0x0F0F0F0F0F0F0F0Full) << 4 |
+                     (board_ >> 4 & 0x0F0F0F0F0F0F0F0Full);
+        return BitBoard4x4((a & 0x00FF00FF00FF00FFull) << 8 |
+                           (a >> 8 & 0x00FF00FF00FF00FFull));
+    }
+
+    /**
+     * Get a well-mixed hash of the board.
+     * Unlike `GameState::Hash`, it is computed from the packed board on every
+     * call, which takes a few instructions.
+     * @return the hash
+     */
+    constexpr uint64_t Hash() const noexcept {
+        uint64_t z = board_ * 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * Get a tile.
+     * @param pos the position of the tile
+     * @return a copy of the tile
+     * @throw std::out_of_range if the position is out of range
+     */
+    Tile tile(Position pos) const;
+
+    /**
+     * Get a list of empty tiles.
+     * Generator side operation.
+     * @return a vector of positions of empty tiles in row-major order
+     */
+    std::vector<Position> GetEmptyTiles() const;
+
+    /**
+     * Count the empty tiles.
+     * Generator side operation.
+     * @return the number of empty tiles in the game grid
+     */
+    uint32_t CountEmptyTiles() const noexcept {
+        return __builtin_popcountll(EmptyNibbles());
+    }
+
+    /**
+     * Find the empty tiles, without allocation.
+     * Generator side operation.
+     * @return a mask with the lowest bit of every empty tile set
+     */
+    constexpr uint64_t EmptyNibbles() const noexcept {
+        uint64_t occupied = board_ | board_ >> 1;
+        occupied |= occupied >> 2;
+        return ~occupied & 0x1111111111111111ull;
+    }
+
+    /**
+     * Get an empty tile without building the list of all empty tiles.
+     * Generator side operation.
+     * @param n the index of the empty tile in row-major order
+     * @return the position of the `n`-th empty tile, which is the same as
+     *      `GetEmptyTiles()[n]`
+     * @throw std::out_of_range if `n` is not less than `CountEmptyTiles()`
+     */
+    Position GetEmptyTile(uint32_t n) const;
+
+    /**
+     * Generate a tile in the game grid.
+     * Generator side operation.
+     * @param pos the position of the new tile
+     * @param power number in the new tile in terms of power of 2
+     * @return true if the tile is generated, false if the position is not empty
+     * @throw std::out_of_range if the position is out of range
+     * @throw std::invalid_argument if `power` is larger than `kMaxPower`
+     */
+    bool GenerateTile(Position pos, uint8_t power);
+
+    /**
+     * Generate a tile in the game grid, and record how to undo it.
+     * Generator side operation.
+     * @param pos the position of the new tile
+     * @param power number in the new tile in terms of power of 2
+     * @param undo output the undo record
+     * @return true if the tile is generated, false if the position is not empty
+     * @throw std::out_of_range if the position is out of range
+     * @throw std::invalid_argument if `power` is larger than `kMaxPower`
+     */
+    bool GenerateTile(Position pos, uint8_t power, UndoRecord *undo) {
+        undo->board_ = board_;
+        undo->valid_ = true;
+        return GenerateTile(pos, power);
+    }
+
+    /**
+     * Get the directions that can be moved in.
+     * Player side operation.
+     * @return a vector of directions that can be moved in, in the same order
+     *      as `GameState::GetPossibleMoves`
+     */
+    std::vector<Direction> GetPossibleMoves() const;
+
+    /**
+     * Get the directions that can be moved in, without allocation.
+     * Player side operation.
+     * @return the set of directions that can be moved in
+     */
+    DirectionMask GetPossibleMoveMask() const noexcept;
+
+    /**
+     * Apply a move.
+     * Player side operation.
+     * A merge that would overflow `kMaxPower` saturates at `kMaxPower`, but
+     * still scores as if it did not.
+     * @param dir the direction
+     * @return the result of the move, as `GameState::Move`
+     */
+    MoveResult Move(Direction dir) noexcept;
+
+    /**
+     * Apply a move, and record how to undo it.
+     * Player side operation.
+     * @param dir the direction
+     * @param undo output the undo record
+     * @return the result of the move, as `GameState::Move`
+     */
+    MoveResult Move(Direction dir, UndoRecord *undo) noexcept {
+        undo->board_ = board_;
+        undo->valid_ = true;
+        return Move(dir);
+    }
+
+    /**
+     * Undo the last recorded move or tile generation.
+     * Records must be undone in the reverse order they were made in. An empty
+     * record undoes nothing.
+     * @param undo the record of the last operation applied to `this`
+     */
+    void Undo(const UndoRecord &undo) noexcept {
+        if (undo.valid_)
+            board_ = undo.board_;
+    }
+
+ private:
+    uint64_t board_;    /**< Packed tiles */
+
+    /**
+     * Get the power of a tile.
+     * @param r the row index
+     * @param c the col index
+     * @pre `r` and `c` are in range
+     * @return the power
+     */
+    constexpr uint8_t power(uint32_t r, uint32_t c) const noexcept {
+        return (board_ >> shift(r, c)) & 0xF;
+    }
+
+    /**
+     * Translate row and col into bit offset in `board_`.
+     * @param r the row index
+     * @param c the col index
+     * @pre `r` and `c` are in range
+     * @return the bit offset
+     */
+    static constexpr uint32_t shift(uint32_t r, uint32_t c) noexcept {
+        return 16 * r + 4 * c;
+    }
+};
+
+/**
+ * Print the board as a human-readable string, in the same format as
+ * `GameState`.
+ * @param os the output stream
+ * @param b the `BitBoard4x4` object
+ * @return `os`
+ */
+std::ostream &operator<<(std::ostream &os, const BitBoard4x4 &b);
+
+}  // namespace _2048
+
+namespace std {
+
+/**
+ * Hash a `BitBoard4x4` for unordered containers, using `BitBoard4x4::Hash`.
+ */
+template <>
+struct hash<_2048::BitBoard4x4> {
+    size_t operator()(const _2048::BitBoard4x4 &b) const noexcept {
+        return b.Hash();
+    }
+};
+
+}  // namespace std
+
+#endif  // _BITBOARD4X4_H_
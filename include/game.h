@@ -30,7 +30,8 @@ class Game {
     explicit Game(Viewer *viewer = nullptr,
                   Generator *generator = nullptr,
                   Player *player = nullptr) noexcept
-            : viewer_(viewer), generator_(generator), player_(player) { }
+            : viewer_(viewer), generator_(generator), player_(player),
+              score_(0) { }
 
     /**
      * Move constructor.
@@ -41,7 +42,8 @@ class Game {
             : state_(std::move(g.state_)),
               viewer_(g.viewer_),
               generator_(g.generator_),
-              player_(g.player_) {
+              player_(g.player_),
+              score_(g.score_) {
         g.viewer_    = nullptr;
         g.generator_ = nullptr;
         g.player_    = nullptr;
@@ -103,8 +105,15 @@ class Game {
         return old_player;
     }
 
+    /**
+     * Get the score, which is the sum of all tiles merged since the last reset.
+     * @return the score
+     */
+    uint64_t GetScore() const noexcept { return score_; }
+
     /**
      * Reset the game to a specific state.
+     * The score is reset to 0.
      * @param state the game state
      * @throw std::runtime_error if `state` is not in a valid state
      */
@@ -112,6 +121,7 @@ class Game {
 
     /**
      * Reset the game to a specific state.
+     * The score is reset to 0.
      * The original game state `state` will be unusable.
      * @param state the game state
      */
@@ -136,12 +146,24 @@ class Game {
     /**
      * Let the player play a move.
      * If there is no player, the operation will fail.
+     * If successful, the score gained by the move is added to the score.
      * If there is a viewer, it will be updated.
      * @return true if successful, otherwise false
      * @throw std::runtime_error if `this` is not in a valid state
      */
     virtual bool Play();
 
+    /**
+     * Let the player play a move within search limits.
+     * If there is no player, the operation will fail.
+     * If successful, the score gained by the move is added to the score.
+     * If there is a viewer, it will be updated.
+     * @param limits the limits on the search of the player
+     * @return true if successful, otherwise false
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    virtual bool Play(const SearchLimits &limits);
+
     /**
      * Destructor
      */
@@ -152,6 +174,7 @@ class Game {
     Viewer    *viewer_;                 /**< Viewer */
     Generator *generator_;              /**< Generator */
     Player    *player_;                 /**< Player */
+    uint64_t   score_;                  /**< Score since the last reset */
 };
 
 }  // namespace _2048
@@ -2,7 +2,9 @@
 #define _GAME_STATE_H_
 
 #include <cstdint>
+#include <cstddef>
 #include <vector>
+#include <functional>
 #include <ostream>
 
 #include "tile.h"
@@ -16,7 +18,6 @@ namespace _2048 {
 class GameState {
  public:
     friend std::ostream &operator<<(std::ostream &os, const GameState &g);
-    GameState &operator=(const GameState &) = delete;
 
     /**
      * A struct packing a row index and a col index.
@@ -37,27 +38,130 @@ class GameState {
      */
     enum class Direction { UP, DOWN, LEFT, RIGHT };
 
+    /**
+     * The directions in the order `GetPossibleMoves` lists them.
+     */
+    static constexpr Direction kDirections[] = {
+        Direction::LEFT, Direction::RIGHT, Direction::UP, Direction::DOWN
+    };
+
+    /**
+     * A set of directions.
+     * Direction `dir` is in the set if bit `static_cast<int>(dir)` is set.
+     */
+    using DirectionMask = uint8_t;
+
+    /**
+     * Get the set containing a single direction.
+     * @param dir the direction
+     * @return the mask with only `dir` in it
+     */
+    static constexpr DirectionMask ToMask(Direction dir) noexcept {
+        return 1 << static_cast<int>(dir);
+    }
+
+    /**
+     * The outcome of a move.
+     */
+    struct MoveResult {
+        bool     moved;     /**< Whether any tile changed */
+        uint64_t score;     /**< Sum of the merged tiles */
+        uint32_t merges;    /**< Number of merges */
+        explicit constexpr MoveResult(bool moved = false, uint64_t score = 0,
+                                      uint32_t merges = 0) noexcept
+                : moved(moved), score(score), merges(merges) { }
+        /** Whether the move is applied, same as `moved` */
+        explicit constexpr operator bool() const noexcept { return moved; }
+    };
+
+    /**
+     * A record of a move or a tile generation, enough to undo it exactly.
+     *
+     * A move is recorded as two bits per tile: whether the tile was occupied
+     * before the move, and whether it holds a merged tile after the move.
+     * Records are meant to be reused; once a record has been used with a grid
+     * of some size, recording into it again does not allocate.
+     */
+    class UndoRecord {
+     public:
+        /**
+         * Construct an empty record.
+         */
+        UndoRecord() noexcept
+                : kind_(Kind::NONE), dir_(Direction::UP), pos_(),
+                  height_(0), width_(0),
+                  num_tiles_(0), max_power_(0), power_sum_(0), hash_(0) { }
+
+     private:
+        friend class GameState;
+
+        /** The kinds of operations that can be recorded */
+        enum class Kind : uint8_t { NONE, TILE, MOVE };
+
+        Kind      kind_;                    /**< Recorded operation */
+        Direction dir_;                     /**< Direction of the move */
+        Position  pos_;                     /**< Position of the new tile */
+        uint32_t  height_;                  /**< Height of the grid */
+        uint32_t  width_;                   /**< Width of the grid */
+        uint32_t  num_tiles_;               /**< Tile count before */
+        uint8_t   max_power_;               /**< Max power before */
+        uint64_t  power_sum_;               /**< Sum of powers before */
+        uint64_t  hash_;                    /**< Hash before */
+        std::vector<uint64_t> occupied_;    /**< Tiles occupied before move */
+        std::vector<uint64_t> merged_;      /**< Tiles merged by move */
+    };
+
     /**
      * Construct an empty `GameState` of size `height` by `width`.
      * @param height the height of the game grid
      * @param width the width of the game grid
      * @throw std::invalid_argument if the size if empty
      */
-    GameState(uint32_t height, uint32_t width) : grid_(height, width) { }
+    GameState(uint32_t height, uint32_t width);
 
     /**
      * Copy constructor
      * @param g the `GameState` to be copied
      * @throw std::runtime_error if `g` is not in a valid state
      */
-    GameState(const GameState &g) : grid_(g.grid_) { }
+    GameState(const GameState &g)
+            : grid_(g.grid_),
+              empty_(g.empty_),
+              num_tiles_(g.num_tiles_),
+              max_power_(g.max_power_),
+              power_sum_(g.power_sum_),
+              hash_(g.hash_) { }
 
     /**
      * Move constructor.
      * The original game state `g` will be unusable.
      * @param g the `GameState` to be moved
      */
-    GameState(GameState &&g) noexcept : grid_(std::move(g.grid_)) { }
+    GameState(GameState &&g) noexcept
+            : grid_(std::move(g.grid_)),
+              empty_(std::move(g.empty_)),
+              num_tiles_(g.num_tiles_),
+              max_power_(g.max_power_),
+              power_sum_(g.power_sum_),
+              hash_(g.hash_) { }
+
+    /**
+     * Copy assignment.
+     * The tiles are copied in place without allocation.
+     * @param g the `GameState` to be copied
+     * @return `*this`
+     * @throw std::invalid_argument if `g` has a different size
+     * @throw std::runtime_error if `g` is not in a valid state
+     */
+    GameState &operator=(const GameState &g) {
+        grid_ = g.grid_;
+        empty_ = g.empty_;
+        num_tiles_ = g.num_tiles_;
+        max_power_ = g.max_power_;
+        power_sum_ = g.power_sum_;
+        hash_ = g.hash_;
+        return *this;
+    }
 
     /**
      * Get game grid height.
@@ -77,7 +181,11 @@ class GameState {
      * @return true if the two game states are identical, false otherwise
      * @throw std::runtime_error if `this` or `g` is not in a valid state
      */
-    bool operator==(const GameState &g) const { return grid_ == g.grid_; }
+    bool operator==(const GameState &g) const {
+        CheckValid();
+        g.CheckValid();
+        return hash_ == g.hash_ && grid_ == g.grid_;
+    }
 
     /**
      * Inequality
@@ -85,7 +193,20 @@ class GameState {
      * @return false if the two game states are identical, true otherwise
      * @throw std::runtime_error if `this` or `g` is not in a valid state
      */
-    bool operator!=(const GameState &g) const { return grid_ != g.grid_; }
+    bool operator!=(const GameState &g) const { return !(*this == g); }
+
+    /**
+     * Get the Zobrist hash of the tiles in O(1).
+     * The hash is the XOR of a pseudo-random key for every non-empty tile,
+     * chosen by its position and power, and is kept up to date by every
+     * operation. Equal game states of the same size have equal hashes.
+     * @return the hash
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    uint64_t Hash() const {
+        CheckValid();
+        return hash_;
+    }
 
     /**
      * Get a tile.
@@ -104,6 +225,40 @@ class GameState {
      */
     std::vector<Position> GetEmptyTiles() const;
 
+    /**
+     * Count the empty tiles in O(1).
+     * Generator side operation.
+     * @return the number of empty tiles in the game grid
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    uint32_t CountEmptyTiles() const {
+        return height() * width() - CountTiles();
+    }
+
+    /**
+     * Get the bitmap of empty tiles.
+     * Generator side operation.
+     * The tile at row `r` and col `c` is empty if bit `(r * width() + c) % 64`
+     * of word `(r * width() + c) / 64` is set. Bits past the last tile are 0.
+     * @return the bitmap
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    const std::vector<uint64_t> &GetEmptyBitmap() const {
+        CheckValid();
+        return empty_;
+    }
+
+    /**
+     * Get an empty tile without building the list of all empty tiles.
+     * Generator side operation.
+     * @param n the index of the empty tile in row-major order
+     * @return the position of the `n`-th empty tile, which is the same as
+     *      `GetEmptyTiles()[n]`
+     * @throw std::out_of_range if `n` is not less than `CountEmptyTiles()`
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    Position GetEmptyTile(uint32_t n) const;
+
     /**
      * Generate a tile in the game grid.
      * Generator side operation.
@@ -115,6 +270,49 @@ class GameState {
      */
     bool GenerateTile(Position pos, uint8_t power);
 
+    /**
+     * Generate a tile in the game grid, and record how to undo it.
+     * Generator side operation.
+     * @param pos the position of the new tile
+     * @param power number in the new tile in terms of power of 2
+     * @param undo output the undo record, which undoes nothing if no tile is
+     *      generated
+     * @return true if the tile is generated, false if the position is not empty
+     * @throw std::out_of_range if the position is out of range
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    bool GenerateTile(Position pos, uint8_t power, UndoRecord *undo);
+
+    /**
+     * Count the tiles that contain a number in O(1).
+     * @return the number of non-empty tiles
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    uint32_t CountTiles() const {
+        CheckValid();
+        return num_tiles_;
+    }
+
+    /**
+     * Get the largest tile in O(1).
+     * @return the power of the largest tile, or 0 if the grid is empty
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    uint8_t GetMaxPower() const {
+        CheckValid();
+        return max_power_;
+    }
+
+    /**
+     * Get the sum of the powers of all tiles in O(1).
+     * @return the sum of powers
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    uint64_t GetPowerSum() const {
+        CheckValid();
+        return power_sum_;
+    }
+
     /**
      * Get the directions that can be moved in.
      * Player side operation.
@@ -124,16 +322,128 @@ class GameState {
     std::vector<Direction> GetPossibleMoves() const;
 
     /**
-     * Apply a move.
+     * Get the directions that can be moved in, without allocation.
+     * Player side operation.
+     * @return the set of directions that can be moved in
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    DirectionMask GetPossibleMoveMask() const;
+
+    /**
+     * Apply a move in a single pass over the grid.
+     * Player side operation.
+     * The score is the sum of the merged tiles, as in the original game.
+     * @param dir the direction
+     * @return the result of the move, which converts to true if the move is
+     *      applied and false if the move is not possible
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    MoveResult Move(Direction dir);
+
+    /**
+     * Apply a move, and record how to undo it.
      * Player side operation.
      * @param dir the direction
-     * @return true if the move is applied, false if the move is not possible
+     * @param undo output the undo record, which undoes nothing if the move is
+     *      not possible, or `nullptr` to skip recording
+     * @return the result of the move
      * @throw std::runtime_error if `this` is not in a valid state
      */
-    bool Move(Direction dir);
+    MoveResult Move(Direction dir, UndoRecord *undo);
+
+    /**
+     * Undo the last recorded move or tile generation.
+     * Records must be undone in the reverse order they were made in. An empty
+     * record undoes nothing.
+     * @param undo the record of the last operation applied to `this`
+     * @throw std::logic_error if `undo` is recorded on a grid of another size
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    void Undo(const UndoRecord &undo);
 
  private:
-    Grid grid_;  /**< Underlying grid */
+    Grid grid_;                     /**< Underlying grid */
+    std::vector<uint64_t> empty_;   /**< Bitmap of empty tiles */
+    uint32_t num_tiles_;            /**< Number of non-empty tiles */
+    uint8_t  max_power_;            /**< Power of the largest tile */
+    uint64_t power_sum_;            /**< Sum of powers of all tiles */
+    uint64_t hash_;                 /**< Zobrist hash of the tiles */
+
+    /**
+     * Get the Zobrist key of a tile.
+     * The keys are computed by mixing the index and the power with the
+     * SplitMix64 finalizer, so no table is needed for any grid size.
+     * @param i the offset of the tile in row-major order
+     * @param power the power of the tile
+     * @return the key
+     */
+    static constexpr uint64_t ZobristKey(size_t i, uint8_t power) noexcept {
+        uint64_t z = (static_cast<uint64_t>(i) << 8 | power) *
+                     0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * Get the XOR of the Zobrist keys of the tiles in a line.
+     * @param first the offset of the first tile of the line
+     * @param length the number of tiles in the line
+     * @param stride the distance between two tiles in the line
+     * @pre `this` is in a valid state
+     * @return the hash of the line
+     */
+    uint64_t HashLine(ptrdiff_t first, uint32_t length,
+                      ptrdiff_t stride) const noexcept;
+
+    /**
+     * Check whether a line can move towards its first tile.
+     * @param first the offset of the first tile of the line
+     * @param length the number of tiles in the line
+     * @param stride the distance between two tiles in the line
+     * @pre `this` is in a valid state
+     * @return true if `MoveLine` would change the line, otherwise false
+     */
+    bool CanMoveLine(ptrdiff_t first, uint32_t length,
+                     ptrdiff_t stride) const noexcept;
+
+    /**
+     * Check that `this` is in a valid state.
+     * @throw std::runtime_error if `this` is not in a valid state
+     */
+    void CheckValid() const { grid_.data(); }
+
+    /**
+     * Refresh the empty tile bitmap of a line.
+     * @param first the offset of the first tile of the line
+     * @param length the number of tiles in the line
+     * @param stride the distance between two tiles in the line
+     * @pre `this` is in a valid state
+     */
+    void UpdateEmptyBitmap(ptrdiff_t first, uint32_t length,
+                           ptrdiff_t stride) noexcept;
+
+    /**
+     * The lines of the grid along a direction.
+     * Line `i` is `length` tiles starting at offset `start + i * step`, where
+     * consecutive tiles are `stride` apart and the first tile is the one the
+     * other tiles move towards.
+     */
+    struct Lines {
+        uint32_t  count;    /**< Number of lines */
+        uint32_t  length;   /**< Number of tiles in each line */
+        ptrdiff_t start;    /**< Offset of the first tile of line 0 */
+        ptrdiff_t step;     /**< Distance between two lines */
+        ptrdiff_t stride;   /**< Distance between two tiles in a line */
+    };
+
+    /**
+     * Get the lines of the grid along a direction.
+     * @param dir the direction
+     * @return the lines
+     */
+    Lines GetLines(Direction dir) const noexcept;
+
     void GetPossibleDir(bool *left, bool *right,
                         bool *up, bool *down) const;
 };
@@ -151,4 +461,18 @@ inline std::ostream &operator<<(std::ostream &os, const GameState &g) {
 
 }  // namespace _2048
 
+namespace std {
+
+/**
+ * Hash a `GameState` for unordered containers, using `GameState::Hash`.
+ */
+template <>
+struct hash<_2048::GameState> {
+    size_t operator()(const _2048::GameState &g) const {
+        return g.Hash();
+    }
+};
+
+}  // namespace std
+
 #endif  // _GAME_STATE_H_
@@ -16,7 +16,6 @@ class Grid {
     const uint32_t height;  /**< the grid height */
     const uint32_t width;   /**< the grid width */
 
-    Grid &operator=(const Grid &) = delete;
     friend std::ostream &operator<<(std::ostream &os, const Grid &g);
 
     /**
@@ -45,6 +44,18 @@ class Grid {
     Grid(Grid &&g) noexcept
             : height(g.height), width(g.width), grid_(std::move(g.grid_)) { }
 
+    /**
+     * Copy assignment.
+     * The tiles are copied in place without allocation. A grid that has been
+     * moved from becomes usable again.
+     * @param g the `Grid` to be copied
+     * @return `*this`
+     * @throw std::invalid_argument if `g` has a different size
+     * @throw std::bad_alloc if memory allocation failed
+     * @throw std::runtime_error if `g` is not in a valid state
+     */
+    Grid &operator=(const Grid &g);
+
     /**
      * Equality
      * @param g the other `Grid` object
@@ -74,6 +85,17 @@ class Grid {
     Tile &tile(uint32_t r, uint32_t c);
     //@}
 
+    //@{
+    /**
+     * Get the underlying tiles without bounds checking.
+     * The tile at row `r` and col `c` is at offset `r * width + c`.
+     * @return a pointer to the first tile
+     * @throw std::runtime_error if this grid is not in a valid state
+     */
+    const Tile *data() const;
+    Tile *data();
+    //@}
+
  private:
     std::unique_ptr<Tile[]> grid_;
 
@@ -0,0 +1,64 @@
+#ifndef _LINE_H_
+#define _LINE_H_
+
+#include <cstdint>
+#include <cstddef>
+
+#include "tile.h"
+
+namespace _2048 {
+
+/**
+ * A merge listener for `MoveLine` that does nothing.
+ */
+struct IgnoreMerge {
+    void operator()(uint32_t) const noexcept { }
+};
+
+/**
+ * Slide and merge a line of tiles towards its first tile.
+ *
+ * The i-th tile of the line is `first[i * stride]`. Each tile merges at most
+ * once per move, and tiles closer to the first tile merge first. When `n` and
+ * `stride` are compile-time constants at the call site, the loop has a constant
+ * trip count and can be fully unrolled.
+ * @param first the first tile of the line, which tiles move towards
+ * @param n the number of tiles in the line
+ * @param stride the distance between two consecutive tiles in the line
+ * @param score incremented by the sum of the merged tiles
+ * @param merges incremented by the number of merges
+ * @param on_merge called with the index in the line of every merged tile
+ * @return true if any tile in the line changed, false otherwise
+ */
+template <typename OnMerge = IgnoreMerge>
+inline bool MoveLine(Tile *first, uint32_t n, ptrdiff_t stride,
+                     uint64_t *score, uint32_t *merges,
+                     OnMerge on_merge = OnMerge()) noexcept {
+    bool changed = false;
+    bool mergeable = false;     // whether the last placed tile can merge
+    uint32_t target = 0;        // number of placed tiles
+    for (uint32_t i = 0; i < n; i++) {
+        const Tile tile = first[i * stride];
+        if (tile.empty())
+            continue;
+        first[i * stride] = Tile::kEmpty;
+        if (mergeable && first[(target - 1) * stride] == tile) {
+            first[(target - 1) * stride] = Tile(tile.power() + 1);
+            *score += 2ull << tile.power();
+            ++*merges;
+            on_merge(target - 1);
+            mergeable = false;
+            changed = true;
+        } else {
+            first[target * stride] = tile;
+            mergeable = true;
+            changed |= target != i;
+            target++;
+        }
+    }
+    return changed;
+}
+
+}  // namespace _2048
+
+#endif  // _LINE_H_
@@ -0,0 +1,52 @@
+#ifndef _LINE_KERNEL_H_
+#define _LINE_KERNEL_H_
+
+#include <cstdint>
+
+namespace _2048 {
+
+/**
+ * Instruction sets that `MovePowers` can run on.
+ */
+enum class LineKernel { SCALAR, SSE4, AVX2 };
+
+/**
+ * The longest line that `MovePowers` accepts.
+ */
+constexpr uint32_t kMaxKernelLine = 32;
+
+/**
+ * Slide and merge a line of tile powers towards its first tile, with the
+ * same result as `MoveLine`.
+ *
+ * The SIMD kernels compact the non-empty tiles with byte shuffles, find the
+ * merging pairs with a single byte compare, and compact again, so there is no
+ * branch per tile.
+ * @param line the powers of the tiles in the line, 0 for an empty tile
+ * @param n the number of tiles in the line, at most `kMaxKernelLine`
+ * @param score incremented by the sum of the merged tiles
+ * @param merges incremented by the number of merges
+ * @param merged set to the mask of the indices in the line of the merged
+ *      tiles after the move
+ * @return true if any tile in the line changed, false otherwise
+ */
+using MovePowersFunc = bool (*)(uint8_t *line, uint32_t n, uint64_t *score,
+                                uint32_t *merges, uint32_t *merged);
+
+/**
+ * Find the fastest kernel the CPU supports.
+ * The CPU is only queried on the first call.
+ * @return the kernel
+ */
+LineKernel BestLineKernel() noexcept;
+
+/**
+ * Get the implementation of a kernel.
+ * @param kernel the kernel, which must be supported by the CPU
+ * @return the kernel function
+ */
+MovePowersFunc GetMovePowers(LineKernel kernel) noexcept;
+
+}  // namespace _2048
+
+#endif  // _LINE_KERNEL_H_
@@ -2,11 +2,56 @@
 #define _PLAYER_H_
 
 #include <cstdint>
+#include <atomic>
+#include <chrono>
 
 #include "game_state.h"
 
 namespace _2048 {
 
+/**
+ * Limits on the search for one move, on top of the limits a player was
+ * constructed with. A search player returns the best move of its last
+ * complete search within the limits.
+ */
+struct SearchLimits {
+    using Clock = std::chrono::steady_clock;
+
+    /** Time to return a move by, or `Clock::time_point::max()` for none */
+    Clock::time_point deadline = Clock::time_point::max();
+
+    /** Maximum number of search nodes, or 0 for no limit */
+    uint64_t nodes = 0;
+
+    /** Maximum search depth in player moves, or 0 for the player's own */
+    uint32_t depth = 0;
+
+    /** Flag that stops the search as soon as it is set, or null */
+    const std::atomic<bool> *stop = nullptr;
+
+    /**
+     * Check whether the search should stop at a point in time, by the
+     * deadline or the stop flag.
+     * @param now the current time
+     * @return true if the search should stop
+     */
+    bool Expired(Clock::time_point now) const noexcept {
+        return now >= deadline ||
+               (stop != nullptr && stop->load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Get limits with a deadline some time from now.
+     * @param time the time from now
+     * @return the limits
+     */
+    static SearchLimits Within(std::chrono::milliseconds time) {
+        SearchLimits limits;
+        limits.deadline = Clock::now() + time;
+        return limits;
+    }
+};
+
 /**
  * Interface of a player that apply moves.
  */
@@ -22,6 +67,21 @@ class Player {
      */
     virtual bool Play(const GameState &state, GameState::Direction *move) = 0;
 
+    /**
+     * Play a move within search limits.
+     * If failed, `*move` will stay unmodified.
+     * Players that do not search ignore the limits.
+     * @param state the current game state
+     * @param move output the direction of the next move
+     * @param limits the limits on the search
+     * @return true if successful, otherwise false
+     * @throw std::runtime_error if `state` is not valid
+     */
+    virtual bool Play(const GameState &state, GameState::Direction *move,
+                      const SearchLimits &limits) {
+        return Play(state, move);
+    }
+
     /**
      * Destructor
      */
@@ -0,0 +1,183 @@
+#ifndef _SYMMETRY_H_
+#define _SYMMETRY_H_
+
+#include <cstdint>
+
+#include "game_state.h"
+#include "bit_board_4x4.h"
+
+namespace _2048 {
+
+/**
+ * One of the 8 rotations and reflections of a square game grid.
+ *
+ * A symmetry first optionally transposes the grid, then optionally reverses
+ * the order of its rows, then optionally reverses the order of its cols.
+ * Moving in direction `dir` and then applying a symmetry `s` gives the same
+ * grid as applying `s` first and then moving in direction `s.Apply(dir)`.
+ */
+class Symmetry {
+ public:
+    using Position  = GameState::Position;
+    using Direction = GameState::Direction;
+
+    static constexpr uint8_t kCount = 8;    /**< Number of symmetries */
+
+    /**
+     * Construct a symmetry from its index.
+     * @param index bit 0 reverses the cols, bit 1 reverses the rows, and bit
+     *      2 transposes the grid; the identity is 0
+     */
+    explicit constexpr Symmetry(uint8_t index = 0) noexcept
+            : index_(index & (kCount - 1)) { }
+
+    /**
+     * Get the index of the symmetry.
+     * @return the index, in [0, kCount)
+     */
+    constexpr uint8_t index() const noexcept { return index_; }
+
+    /**
+     * Check whether the grid is transposed.
+     * @return true if the grid is transposed
+     */
+    constexpr bool transpose() const noexcept { return index_ & 4; }
+
+    /**
+     * Check whether the rows are reversed, after transposing.
+     * @return true if the order of rows is reversed
+     */
+    constexpr bool mirror_rows() const noexcept { return index_ & 2; }
+
+    /**
+     * Check whether the cols are reversed, after transposing.
+     * @return true if the order of cols is reversed
+     */
+    constexpr bool mirror_cols() const noexcept { return index_ & 1; }
+
+    /**
+     * Equality
+     * @param s the other `Symmetry` object
+     * @return true if the two symmetries are the same, false otherwise
+     */
+    constexpr bool operator==(const Symmetry &s) const noexcept {
+        return index_ == s.index_;
+    }
+
+    /**
+     * Inequality
+     * @param s the other `Symmetry` object
+     * @return false if the two symmetries are the same, true otherwise
+     */
+    constexpr bool operator!=(const Symmetry &s) const noexcept {
+        return index_ != s.index_;
+    }
+
+    /**
+     * Get the symmetry that undoes this one.
+     * @return the inverse symmetry
+     */
+    constexpr Symmetry Inverse() const noexcept {
+        // (mirror . transpose)^-1 = transpose . mirror, which mirrors the
+        // other axis after transposing
+        if (!transpose())
+            return *this;
+        return Symmetry(4 | (index_ & 1) << 1 | (index_ & 2) >> 1);
+    }
+
+    /**
+     * Map a position.
+     * @param pos the position before the symmetry
+     * @param n the size of the square grid
+     * @return the position of the same tile after the symmetry
+     */
+    constexpr Position Apply(Position pos, uint32_t n) const noexcept {
+        uint32_t r = transpose() ? pos.c : pos.r;
+        uint32_t c = transpose() ? pos.r : pos.c;
+        return Position(mirror_rows() ? n - 1 - r : r,
+                        mirror_cols() ? n - 1 - c : c);
+    }
+
+    /**
+     * Map a direction.
+     * @param dir the direction before the symmetry
+     * @return the direction after the symmetry
+     */
+    constexpr Direction Apply(Direction dir) const noexcept {
+        bool vertical = dir == Direction::UP || dir == Direction::DOWN;
+        bool forward  = dir == Direction::DOWN || dir == Direction::RIGHT;
+        if (transpose())
+            vertical = !vertical;
+        if (vertical ? mirror_rows() : mirror_cols())
+            forward = !forward;
+        if (vertical)
+            return forward ? Direction::DOWN : Direction::UP;
+        return forward ? Direction::RIGHT : Direction::LEFT;
+    }
+
+ private:
+    uint8_t index_;     /**< Transpose, row and col bits */
+};
+
+/**
+ * A board in canonical form, and the symmetry that maps the original board to
+ * it. A best move `dir` on `board` is the move `symmetry.Inverse().Apply(dir)`
+ * on the original board.
+ * @tparam Board the board type
+ */
+template <typename Board>
+struct Canonical {
+    Board    board;     /**< The canonical board */
+    Symmetry symmetry;  /**< The symmetry mapping the original board to it */
+};
+
+/**
+ * Apply a symmetry to a packed board.
+ * @param board the board
+ * @param s the symmetry
+ * @return the board after the symmetry
+ */
+constexpr BitBoard4x4 Transform(BitBoard4x4 board, Symmetry s) noexcept {
+    if (s.transpose())
+        board = board.Transpose();
+    if (s.mirror_rows())
+        board = board.MirrorRows();
+    if (s.mirror_cols())
+        board = board.MirrorCols();
+    return board;
+}
+
+/**
+ * Apply a symmetry to a square game state.
+ * @param state the game state
+ * @param s the symmetry
+ * @return the game state after the symmetry
+ * @throw std::invalid_argument if `state` is not square
+ * @throw std::runtime_error if `state` is not in a valid state
+ */
+GameState Transform(const GameState &state, Symmetry s);
+
+/**
+ * Find the canonical form of a packed board, which is the symmetric copy with
+ * the smallest packed representation. All 8 symmetric copies of a board have
+ * the same canonical form.
+ * @param board the board
+ * @return the canonical board and its symmetry
+ */
+Canonical<BitBoard4x4> Canonicalize(BitBoard4x4 board) noexcept;
+
+/**
+ * Find the canonical form of a square game state, which is the symmetric copy
+ * whose powers in reverse row-major order are lexicographically the smallest.
+ * All 8 symmetric copies of a game state have the same canonical form, and a
+ * 4 by 4 game state has the same canonical form as its `BitBoard4x4`.
+ * @param state the game state
+ * @return the canonical game state and its symmetry
+ * @throw std::invalid_argument if `state` is not square
+ * @throw std::runtime_error if `state` is not in a valid state
+ */
+Canonical<GameState> Canonicalize(const GameState &state);
+
+}  // namespace _2048
+
+#endif  // _SYMMETRY_H_
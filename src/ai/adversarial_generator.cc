@@ -0,0 +1,223 @@
+#include "ai/adversarial_generator.h"
+
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+#include "bit_board_4x4.h"
+
+namespace _2048 {
+namespace ai {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using eval::EvaluationFunction;
+
+// nodes between two checks of the clock
+constexpr uint64_t kClockInterval = 1024;
+
+// alpha-beta minimax over a game state of type `State`, valued for the player
+// each ply owns one undo record, so records are reused across the search
+template <typename State>
+class Adversary {
+ public:
+    Adversary(const EvaluationFunction &eval, uint32_t max_depth,
+              Clock::time_point deadline)
+            : eval_(eval), undos_(2 * max_depth), deadline_(deadline),
+              interruptible_(false), expired_(false), nodes_(0) { }
+
+    uint64_t nodes() const noexcept { return nodes_; }
+    bool expired() const noexcept { return expired_; }
+
+    // whether the next iteration may be interrupted by the deadline
+    void set_interruptible(bool interruptible) noexcept {
+        interruptible_ = interruptible;
+    }
+
+    // value of tile `i` of the root, numbered 2 * empty tile + power - 1,
+    // with `depth` player moves left
+    int64_t Root(State *state, uint32_t i, uint32_t depth, int64_t alpha,
+                 int64_t beta) {
+        state->GenerateTile(state->GetEmptyTile(i / 2), i % 2 + 1,
+                            &undos_[0]);
+        const int64_t value = Max(state, depth, alpha, beta, 1);
+        state->Undo(undos_[0]);
+        return value;
+    }
+
+ private:
+    const EvaluationFunction &eval_;
+    std::vector<typename State::UndoRecord> undos_;
+    Clock::time_point deadline_;
+    bool interruptible_;
+    bool expired_;
+    uint64_t nodes_;
+
+    // count a node, and check the clock every `kClockInterval` nodes
+    bool Visit() {
+        if (++nodes_ % kClockInterval == 0 && interruptible_ &&
+                Clock::now() >= deadline_)
+            expired_ = true;
+        return !expired_;
+    }
+
+    // value of a player node with `depth` moves left, valued after the last
+    int64_t Max(State *state, uint32_t depth, int64_t alpha, int64_t beta,
+                uint32_t ply) {
+        if (!Visit())
+            return 0;
+        const GameState::DirectionMask mask = state->GetPossibleMoveMask();
+        if (mask == 0)
+            return EvaluationFunction::kOver;
+        int64_t value = EvaluationFunction::kNegInf;
+        for (GameState::Direction dir : GameState::kDirections) {
+            if (!(mask & GameState::ToMask(dir)))
+                continue;
+            state->Move(dir, &undos_[ply]);
+            const int64_t child = depth == 1 ?
+                                  eval_(*state) :
+                                  Min(state, depth - 1, alpha, beta, ply + 1);
+            state->Undo(undos_[ply]);
+            if (expired_)
+                return 0;
+            value = std::max(value, child);
+            alpha = std::max(alpha, value);
+            if (alpha >= beta)
+                break;
+        }
+        return value;
+    }
+
+    // value of a generator node, whose player children have `depth` moves
+    // left
+    int64_t Min(State *state, uint32_t depth, int64_t alpha, int64_t beta,
+                uint32_t ply) {
+        if (!Visit())
+            return 0;
+        const uint32_t count = state->CountEmptyTiles();
+        if (count == 0)
+            return Max(state, depth, alpha, beta, ply);
+        int64_t value = EvaluationFunction::kPosInf;
+        for (uint32_t i = 0; i < 2 * count; i++) {
+            state->GenerateTile(state->GetEmptyTile(i / 2), i % 2 + 1,
+                                &undos_[ply]);
+            const int64_t child = Max(state, depth, alpha, beta, ply + 1);
+            state->Undo(undos_[ply]);
+            if (expired_)
+                return 0;
+            value = std::min(value, child);
+            beta = std::min(beta, value);
+            if (alpha >= beta)
+                break;
+        }
+        return value;
+    }
+};
+
+}  // namespace
+
+// constructor
+AdversarialGenerator::AdversarialGenerator(
+        const eval::EvaluationFunction *eval, uint32_t depth,
+        std::chrono::milliseconds time_limit, uint64_t seed)
+        : eval_(eval), max_depth_(depth), time_limit_(time_limit),
+          engine_(seed), searched_depth_(0), value_(0), nodes_(0) {
+    if (eval == nullptr)
+        throw std::invalid_argument("null evaluation function");
+    if (depth == 0)
+        throw std::invalid_argument("search depth must be positive");
+    if (depth > kMaxDepth)
+        throw std::invalid_argument("search depth too large");
+}
+
+// search
+template <typename State>
+uint32_t AdversarialGenerator::Search(State state) {
+    const Clock::time_point deadline =
+            time_limit_.count() > 0 ? Clock::now() + time_limit_ :
+                                      Clock::time_point::max();
+
+    // root tiles, ordered by the values of the previous iteration
+    struct RootTile {
+        uint32_t tile;
+        int64_t value;
+    };
+    std::vector<RootTile> tiles(2 * state.CountEmptyTiles());
+    for (uint32_t i = 0; i < tiles.size(); i++)
+        tiles[i] = RootTile{i, 0};
+
+    Adversary<State> search(*eval_, max_depth_, deadline);
+    uint32_t best = 0;
+    for (uint32_t depth = time_limit_.count() > 0 ? 1 : max_depth_;
+            depth <= max_depth_; depth++) {
+        search.set_interruptible(depth > 1);
+        std::vector<RootTile> values(tiles);
+        // a tile only gets a lower bound if it is worse for the player than
+        // the worst so far, so every tile as bad as that one is valued
+        // exactly, and ties are broken evenly
+        int64_t beta = EvaluationFunction::kPosInf;
+        uint32_t choice = values[0].tile;
+        uint32_t ties = 0;
+        for (RootTile &root : values) {
+            root.value = search.Root(&state, root.tile, depth,
+                                     EvaluationFunction::kNegInf,
+                                     beta == EvaluationFunction::kPosInf ?
+                                     beta : beta + 1);
+            if (search.expired())
+                break;
+            if (root.value < beta) {
+                beta = root.value;
+                choice = root.tile;
+                ties = 1;
+            } else if (root.value == beta &&
+                       std::uniform_int_distribution<uint32_t>(
+                               0, ties++)(engine_) == 0) {
+                choice = root.tile;
+            }
+        }
+        if (search.expired())
+            break;
+
+        std::stable_sort(values.begin(), values.end(),
+                         [](const RootTile &a, const RootTile &b) {
+                             return a.value < b.value;
+                         });
+        tiles = values;
+        best = choice;
+        searched_depth_ = depth;
+        value_ = beta;
+        if (value_ == EvaluationFunction::kOver)
+            break;
+    }
+    nodes_ = search.nodes();
+    return best;
+}
+
+// generate
+bool AdversarialGenerator::Generate(const GameState &state,
+                                    GameState::Position *pos,
+                                    uint8_t *power) {
+    searched_depth_ = 0;
+    value_ = 0;
+    nodes_ = 0;
+    if (state.CountEmptyTiles() == 0)
+        return false;
+    uint32_t tile;
+    if (state.height() == BitBoard4x4::kHeight &&
+            state.width() == BitBoard4x4::kWidth &&
+            state.GetMaxPower() <= BitBoard4x4::kMaxPower)
+        tile = Search(BitBoard4x4(state));
+    else
+        tile = Search(GameState(state));
+    if (pos != nullptr)
+        *pos = state.GetEmptyTile(tile / 2);
+    if (power != nullptr)
+        *power = tile % 2 + 1;
+    return true;
+}
+
+}  // namespace ai
+}  // namespace _2048
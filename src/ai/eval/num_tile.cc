@@ -9,13 +9,19 @@ namespace eval {
 
 // operator()
 int64_t NumTile::operator()(const GameState &state) const {
-    int64_t sum = 0;
-    for (uint32_t r = 0; r < state.height(); r++)
-        for (uint32_t c = 0; c < state.width(); c++) {
-            const Tile &tile = state.tile(GameState::Position(r, c));
-            sum += tile.empty() ? 0 : -1;
-        }
-    return sum;
+    return -static_cast<int64_t>(state.CountTiles());
+}
+
+// operator() on packed board
+int64_t NumTile::operator()(const BitBoard4x4 &board) const {
+    return static_cast<int64_t>(board.CountEmptyTiles()) -
+           BitBoard4x4::kHeight * BitBoard4x4::kWidth;
+}
+
+// bounds
+EvaluationFunction::Range NumTile::GetRange(uint32_t height, uint32_t width,
+                                            uint8_t max_power) const {
+    return Range{-static_cast<int64_t>(height) * width, 0};
 }
 
 }  // namespace eval
@@ -8,13 +8,24 @@ namespace eval {
 
 // operator()
 int64_t SumExponents::operator()(const GameState &state) const {
+    return -static_cast<int64_t>(state.GetPowerSum());
+}
+
+// operator() on packed board
+int64_t SumExponents::operator()(const BitBoard4x4 &board) const {
     int64_t sum = 0;
-    for (uint32_t r = 0; r < state.height(); r++)
-        for (uint32_t c = 0; c < state.width(); c++)
-            sum -= state.tile(GameState::Position(r, c)).power();
+    for (uint64_t b = board.raw(); b != 0; b >>= 4)
+        sum -= b & 0xF;
     return sum;
 }
 
+// bounds
+EvaluationFunction::Range SumExponents::GetRange(uint32_t height,
+                                                 uint32_t width,
+                                                 uint8_t max_power) const {
+    return Range{-static_cast<int64_t>(height) * width * max_power, 0};
+}
+
 }  // namespace eval
 }  // namespace ai
 }  // namespace _2048
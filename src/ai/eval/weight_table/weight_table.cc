@@ -23,6 +23,41 @@ int64_t WeightTable::operator()(const GameState &state) const {
     return sum;
 }
 
+// operator() on packed board
+int64_t WeightTable::operator()(const BitBoard4x4 &board) const {
+    if (height_ != BitBoard4x4::kHeight || width_ != BitBoard4x4::kWidth)
+        throw std::invalid_argument(
+                "BitBoard4x4 and wight table have mismatch size");
+    int64_t sum = 0;
+    uint64_t b = board.raw();
+    for (uint32_t i = 0; i < height_ * width_; i++, b >>= 4)
+        if ((b & 0xF) != 0)
+            sum += (1 << (b & 0xF)) * weights_[i];
+    return sum;
+}
+
+// bounds
+EvaluationFunction::Range WeightTable::GetRange(uint32_t height,
+                                                uint32_t width,
+                                                uint8_t max_power) const {
+    if (height != height_ || width != width_)
+        throw std::invalid_argument(
+                "Range and wight table have mismatch size");
+    // tile values from 2^31 overflow in the evaluation
+    if (max_power > 30)
+        return Range{kNegInf, kPosInf};
+    // every tile is empty or at most 2^max_power
+    Range range{0, 0};
+    for (uint32_t i = 0; i < height_ * width_; i++) {
+        const int64_t extreme = (int64_t(1) << max_power) * weights_[i];
+        if (extreme < 0)
+            range.lower += extreme;
+        else
+            range.upper += extreme;
+    }
+    return range;
+}
+
 // constructor
 WeightTable::WeightTable(uint32_t height, uint32_t width,
                          const int64_t *weights)
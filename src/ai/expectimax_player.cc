@@ -0,0 +1,521 @@
+#include "ai/expectimax_player.h"
+
+#include <cstdint>
+#include <cmath>
+#include <cstring>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "bit_board_4x4.h"
+#include "ai/thread_pool.h"
+
+namespace _2048 {
+namespace ai {
+
+namespace {
+
+// probability that a new tile is 2, as in `RandomGenerator`
+constexpr double kProbTwo = 0.9;
+
+// mixed into the keys of chance nodes, which may share a board with a player
+// node
+constexpr uint64_t kChanceKey = 0x9E3779B97F4A7C15;
+
+// search nodes with fewer moves left are too small to be tasks
+constexpr uint32_t kTaskDepth = 2;
+
+// nodes of a thread between two checks of the limits
+constexpr uint64_t kCheckInterval = 1024;
+
+using Clock = std::chrono::steady_clock;
+
+using Table = ExpectimaxPlayer::Table;
+
+// mix a number into a table key
+inline uint64_t Mix(uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EB;
+    return x ^ (x >> 31);
+}
+
+// node counters of one thread, on a cache line of their own
+struct alignas(64) Counters {
+    uint64_t nodes = 0;
+    uint64_t cutoffs = 0;
+    uint64_t reused = 0;
+};
+
+// expectimax over a game state of type `State`
+// each ply owns one undo record, so records are reused across the search
+//
+// with pruning, every node is searched with a window (alpha, beta) as in
+// Ballard's *-minimax: a value not above alpha is only an upper bound, and a
+// value not below beta is only a lower bound
+//
+// with a thread pool, the children of large nodes are searched as tasks,
+// which may split again; their values are combined in the serial order
+//
+// with a probability threshold, the value of a node depends on the
+// probability of its path too, so the table keys include it; a stored value
+// is then that of the same search, and tables never change the chosen move
+//
+// a search stopped by the limits returns meaningless values, and stores
+// nothing in the tables
+template <typename State>
+class Expectimax {
+ public:
+    // `lower` and `upper` bound every value in the search, or are infinite
+    // for no pruning
+    // `tables` has one table per thread of `pool`, or is empty
+    // the depth of `limits` is not used
+    Expectimax(const eval::EvaluationFunction &eval, double min_probability,
+               double lower, double upper, ThreadPool *pool,
+               const std::vector<std::unique_ptr<Table>> &tables,
+               const SearchLimits &limits)
+            : eval_(eval), min_probability_(min_probability), lower_(lower),
+              upper_(upper),
+              prune_(std::isfinite(lower) && std::isfinite(upper)),
+              pool_(pool != nullptr && pool->size() > 1 ? pool : nullptr),
+              tables_(tables), limits_(limits),
+              interruptible_(false), stopped_(false),
+              checked_(0), counters_(pool != nullptr ? pool->size() : 1) { }
+
+    bool stopped() const noexcept {
+        return stopped_.load(std::memory_order_relaxed);
+    }
+
+    // whether the next iteration may be stopped by the limits
+    void set_interruptible(bool interruptible) noexcept {
+        interruptible_ = interruptible;
+    }
+
+    uint64_t nodes() const noexcept {
+        uint64_t nodes = 0;
+        for (const Counters &counters : counters_)
+            nodes += counters.nodes;
+        return nodes;
+    }
+
+    uint64_t cutoffs() const noexcept {
+        uint64_t cutoffs = 0;
+        for (const Counters &counters : counters_)
+            cutoffs += counters.cutoffs;
+        return cutoffs;
+    }
+
+    uint64_t reused() const noexcept {
+        uint64_t reused = 0;
+        for (const Counters &counters : counters_)
+            reused += counters.reused;
+        return reused;
+    }
+
+    // search the root `depth` moves deep on the calling thread
+    void Root(State *state, uint32_t depth, GameState::Direction *best) {
+        const uint32_t thread = pool_ != nullptr ? pool_->CurrentThread() : 0;
+        Context context = MakeContext(thread, depth);
+        Max(&context, state, depth, 0, 1, -kInf, kInf, best);
+    }
+
+ private:
+    static constexpr double kInf = std::numeric_limits<double>::infinity();
+    static constexpr double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+    // the state of one task
+    struct Context {
+        std::vector<typename State::UndoRecord> undos;  // one per ply
+        Table *table;           // table of the thread, or null
+        Counters *counters;     // counters of the thread
+    };
+
+    const eval::EvaluationFunction &eval_;
+    double min_probability_;
+    double lower_;
+    double upper_;
+    bool prune_;
+    ThreadPool *pool_;
+    const std::vector<std::unique_ptr<Table>> &tables_;
+    SearchLimits limits_;
+    bool interruptible_;
+    std::atomic<bool> stopped_;
+    std::atomic<uint64_t> checked_;     // nodes counted against the limit
+    std::vector<Counters> counters_;
+
+    // count a node, and check the limits every `kCheckInterval` nodes of the
+    // thread
+    // return false if the search is stopped
+    bool Visit(Context *context) {
+        if (++context->counters->nodes % kCheckInterval == 0 &&
+                interruptible_) {
+            const uint64_t checked = checked_.fetch_add(
+                    kCheckInterval, std::memory_order_relaxed);
+            if ((limits_.nodes != 0 &&
+                 checked + kCheckInterval >= limits_.nodes) ||
+                    limits_.Expired(Clock::now()))
+                stopped_.store(true, std::memory_order_relaxed);
+        }
+        return !stopped();
+    }
+
+    // the context of a task on `thread` with `depth` moves left
+    Context MakeContext(uint32_t thread, uint32_t depth) {
+        return Context{std::vector<typename State::UndoRecord>(2 * depth),
+                       tables_.empty() ? nullptr : tables_[thread].get(),
+                       &counters_[thread]};
+    }
+
+    // the table key of a node reached with probability `prob`
+    uint64_t Key(const State &state, double prob) const noexcept {
+        if (min_probability_ == 0)
+            return state.Hash();
+        uint64_t bits;
+        std::memcpy(&bits, &prob, sizeof(bits));
+        return state.Hash() ^ Mix(bits);
+    }
+
+    // whether the children of a node, with `depth` moves left each, are
+    // worth running as tasks
+    // with pruning, only children whose windows cannot cut are split, so
+    // that they need not wait for the values of their siblings
+    bool Split(uint32_t depth, double alpha, double beta) const noexcept {
+        return pool_ != nullptr && depth >= kTaskDepth &&
+               (!prune_ || (alpha <= lower_ && beta >= upper_));
+    }
+
+    // value of a player node with `depth` moves left, reached with
+    // probability `prob`
+    double Max(Context *context, State *state, uint32_t depth, uint32_t ply,
+               double prob, double alpha, double beta,
+               GameState::Direction *best = nullptr) {
+        if (!Visit(context))
+            return 0;
+        if (depth == 0)
+            return eval_(*state);
+        if (prob < min_probability_) {
+            context->counters->cutoffs++;
+            return eval_(*state);
+        }
+        const GameState::DirectionMask mask = state->GetPossibleMoveMask();
+        if (mask == 0)
+            return eval::EvaluationFunction::kOver;
+        const uint64_t key = Key(*state, prob);
+        Table::Entry entry{0, 0, Table::Bound::NONE, Table::kNoMove};
+        if (Probe(context, key, depth, alpha, beta, &entry) &&
+                entry.move != Table::kNoMove) {
+            if (best != nullptr)
+                *best = GameState::kDirections[entry.move];
+            return entry.value;
+        }
+
+        double value = eval::EvaluationFunction::kNegInf;
+        uint8_t move = Table::kNoMove;
+        if (Split(depth, alpha, beta)) {
+            double values[4];
+            pool_->Run(4, [&](uint32_t thread, uint32_t i) {
+                const GameState::Direction dir = GameState::kDirections[i];
+                if (!(mask & GameState::ToMask(dir)))
+                    return;
+                State child(*state);
+                child.Move(dir);
+                Context task = MakeContext(thread, depth);
+                values[i] = Chance(&task, &child, depth, 0, prob, alpha, beta);
+            });
+            if (stopped())
+                return 0;
+            for (uint8_t i = 0; i < 4; i++)
+                if ((mask & GameState::ToMask(GameState::kDirections[i])) &&
+                        values[i] > value) {
+                    value = values[i];
+                    move = i;
+                }
+        } else {
+            // try the best move of an earlier search first, which is often
+            // the best move of this one, so that more of the others fail low
+            // a move before the best one in `kDirections` order wins a tie,
+            // so its window starts just below the best value
+            const uint8_t first = entry.move < 4 ? entry.move : 0;
+            for (uint8_t k = 0; k < 4; k++) {
+                const uint8_t i = k == 0 ? first : (k == first ? 0 : k);
+                const GameState::Direction dir = GameState::kDirections[i];
+                if (!(mask & GameState::ToMask(dir)))
+                    continue;
+                double child_alpha = std::max(alpha, value);
+                if (i < move && child_alpha == value)
+                    child_alpha = std::nextafter(value, -kInf);
+                state->Move(dir, &context->undos[ply]);
+                const double child = Chance(context, state, depth, ply + 1,
+                                            prob, child_alpha, beta);
+                state->Undo(context->undos[ply]);
+                if (stopped())
+                    return 0;
+                if (child > value || (child == value && i < move)) {
+                    value = child;
+                    move = i;
+                }
+                if (value >= beta)
+                    break;
+            }
+        }
+        if (best != nullptr)
+            *best = GameState::kDirections[move];
+        Store(context, key, depth, alpha, beta, value, move);
+        return value;
+    }
+
+    // value of a chance node, whose player children have `depth - 1` moves
+    // left, reached with probability `prob`
+    double Chance(Context *context, State *state, uint32_t depth,
+                  uint32_t ply, double prob, double alpha, double beta) {
+        if (!Visit(context))
+            return 0;
+        const uint32_t count = state->CountEmptyTiles();
+        if (count == 0)
+            return Max(context, state, depth - 1, ply, prob, alpha, beta);
+        const uint64_t key = Key(*state, prob) ^ kChanceKey;
+        Table::Entry entry;
+        if (Probe(context, key, depth, alpha, beta, &entry))
+            return entry.value;
+
+        // the value is `sum / count`, where every tile weighs `kProbTwo` for
+        // a 2 and `1 - kProbTwo` for a 4
+        // child `2 * i + power - 1` is a tile of `power` on empty tile `i`
+        double sum = 0;
+        double value = kNaN;
+        if (Split(depth - 1, alpha, beta)) {
+            std::vector<double> values(2 * count);
+            pool_->Run(2 * count, [&](uint32_t thread, uint32_t k) {
+                const double weight = k % 2 == 0 ? kProbTwo : 1 - kProbTwo;
+                State child(*state);
+                child.GenerateTile(child.GetEmptyTile(k / 2), k % 2 + 1);
+                Context task = MakeContext(thread, depth - 1);
+                values[k] = Max(&task, &child, depth - 1, 0,
+                                prob * weight / count, -kInf, kInf);
+            });
+            if (stopped())
+                return 0;
+            for (uint32_t k = 0; k < 2 * count; k++)
+                sum += (k % 2 == 0 ? kProbTwo : 1 - kProbTwo) * values[k];
+        } else {
+            for (uint32_t i = 0; i < count && std::isnan(value); i++) {
+                const GameState::Position pos = state->GetEmptyTile(i);
+                for (uint8_t power = 1; power <= 2; power++) {
+                    const double weight = power == 1 ? kProbTwo : 1 - kProbTwo;
+                    // Star1: the window of the child follows from the window of
+                    // the node and the bounds of the outcomes after it
+                    const double rest = count - i - 1 +
+                                        (power == 1 ? 1 - kProbTwo : 0);
+                    double child_alpha = -kInf, child_beta = kInf;
+                    if (prune_) {
+                        child_alpha = (alpha * count - sum - upper_ * rest) /
+                                      weight;
+                        child_beta = (beta * count - sum - lower_ * rest) /
+                                     weight;
+                    }
+                    state->GenerateTile(pos, power, &context->undos[ply]);
+                    const double child = Max(context, state, depth - 1, ply + 1,
+                                             prob * weight / count,
+                                             child_alpha, child_beta);
+                    state->Undo(context->undos[ply]);
+                    if (stopped())
+                        return 0;
+                    sum += weight * child;
+                    if (child <= child_alpha) {
+                        value = std::min(alpha, (sum + upper_ * rest) / count);
+                        break;
+                    }
+                    if (child >= child_beta) {
+                        value = std::max(beta, (sum + lower_ * rest) / count);
+                        break;
+                    }
+                }
+            }
+        }
+        if (std::isnan(value))
+            value = sum / count;
+        Store(context, key, depth, alpha, beta, value, Table::kNoMove);
+        return value;
+    }
+
+    // look up a node searched to `depth` before
+    // return true if the stored value decides the node within the window,
+    // and count the node as reused if an earlier play stored the value
+    // otherwise `entry` is left with the stored result, if any
+    bool Probe(Context *context, uint64_t key, uint32_t depth, double alpha,
+               double beta, Table::Entry *entry) {
+        bool earlier = false;
+        const bool decided =
+                context->table != nullptr &&
+                context->table->Probe(key, entry, &earlier) &&
+                entry->depth == depth &&
+                (entry->bound == Table::Bound::EXACT ||
+                 (entry->bound == Table::Bound::LOWER &&
+                  entry->value >= beta) ||
+                 (entry->bound == Table::Bound::UPPER &&
+                  entry->value <= alpha));
+        if (decided && earlier)
+            context->counters->reused++;
+        return decided;
+    }
+
+    // store the result of a node searched with the window (alpha, beta)
+    void Store(Context *context, uint64_t key, uint32_t depth, double alpha,
+               double beta, double value, uint8_t move) {
+        if (context->table == nullptr || stopped())
+            return;
+        const Table::Bound bound = value <= alpha ? Table::Bound::UPPER :
+                                   value >= beta ? Table::Bound::LOWER :
+                                   Table::Bound::EXACT;
+        context->table->Store(key, Table::Entry{value,
+                                                static_cast<uint8_t>(depth),
+                                                bound, move});
+    }
+};
+
+}  // namespace
+
+// constructor
+ExpectimaxPlayer::ExpectimaxPlayer(const eval::EvaluationFunction *eval,
+                                   uint32_t depth, size_t table_mb,
+                                   double min_probability, bool prune,
+                                   uint32_t threads)
+        : ExpectimaxPlayer(nullptr, eval, depth, 0, min_probability, prune) {
+    if (threads != 1) {
+        own_pool_ = std::make_unique<ThreadPool>(threads);
+        pool_ = own_pool_.get();
+    }
+    table_mb_ = table_mb;
+    CreateTables();
+}
+
+// constructor with a shared pool
+ExpectimaxPlayer::ExpectimaxPlayer(const eval::EvaluationFunction *eval,
+                                   uint32_t depth, size_t table_mb,
+                                   double min_probability, bool prune,
+                                   ThreadPool &pool)
+        : ExpectimaxPlayer(&pool, eval, depth, table_mb, min_probability,
+                           prune) { }
+
+// constructor with a pool or none
+ExpectimaxPlayer::ExpectimaxPlayer(ThreadPool *pool,
+                                   const eval::EvaluationFunction *eval,
+                                   uint32_t depth, size_t table_mb,
+                                   double min_probability, bool prune)
+        : eval_(eval), depth_(depth), min_probability_(min_probability),
+          prune_(prune), table_mb_(table_mb), pool_(pool),
+          searched_depth_(0), nodes_(0), cutoffs_(0), reused_(0) {
+    if (eval == nullptr)
+        throw std::invalid_argument("null evaluation function");
+    if (depth == 0)
+        throw std::invalid_argument("search depth must be positive");
+    if (depth > kMaxDepth)
+        throw std::invalid_argument("search depth too large");
+    if (!(min_probability >= 0 && min_probability <= 1))
+        throw std::invalid_argument("probability threshold out of range");
+    CreateTables();
+}
+
+// destructor
+ExpectimaxPlayer::~ExpectimaxPlayer() noexcept { }
+
+// number of threads
+uint32_t ExpectimaxPlayer::threads() const noexcept {
+    return pool_ != nullptr ? pool_->size() : 1;
+}
+
+// create one table per thread, each with a share of the memory budget
+void ExpectimaxPlayer::CreateTables() {
+    tables_.clear();
+    if (table_mb_ > 0)
+        for (uint32_t i = 0; i < threads(); i++)
+            tables_.push_back(std::make_unique<Table>(
+                    std::max<size_t>(table_mb_ / threads(), 1)));
+}
+
+// search
+template <typename State>
+bool ExpectimaxPlayer::Search(State state, uint32_t max_depth,
+                              const eval::EvaluationFunction::Range &range,
+                              const SearchLimits &limits,
+                              GameState::Direction *move) {
+    using eval::EvaluationFunction;
+    constexpr double kInf = std::numeric_limits<double>::infinity();
+    searched_depth_ = 0;
+    nodes_ = 0;
+    cutoffs_ = 0;
+    reused_ = 0;
+    if (state.GetPossibleMoveMask() == 0)
+        return false;
+    for (auto &table : tables_)
+        table->NewSearch();
+
+    // values of the search also include `kOver`
+    double lower = -kInf, upper = kInf;
+    if (prune_ && range.lower != EvaluationFunction::kNegInf &&
+            range.upper != EvaluationFunction::kPosInf) {
+        lower = std::min(range.lower, EvaluationFunction::kOver);
+        upper = std::max(range.upper, EvaluationFunction::kOver);
+    }
+
+    Expectimax<State> search(*eval_, min_probability_, lower, upper, pool_,
+                             tables_, limits);
+
+    // without limits, search the full depth at once; with limits, deepen
+    // one move at a time, and keep the move of the last complete iteration
+    const bool limited = limits.deadline != Clock::time_point::max() ||
+                         limits.nodes != 0 || limits.stop != nullptr;
+    GameState::Direction best = GameState::Direction::UP;
+    for (uint32_t depth = limited ? 1 : max_depth; depth <= max_depth;
+            depth++) {
+        search.set_interruptible(depth > 1);
+        GameState::Direction dir = GameState::Direction::UP;
+        search.Root(&state, depth, &dir);
+        if (search.stopped())
+            break;
+        best = dir;
+        searched_depth_ = depth;
+    }
+    nodes_ = search.nodes();
+    cutoffs_ = search.cutoffs();
+    reused_ = search.reused();
+    if (move != nullptr)
+        *move = best;
+    return true;
+}
+
+// play
+bool ExpectimaxPlayer::Play(const GameState &state,
+                            GameState::Direction *move) {
+    return Play(state, move, SearchLimits());
+}
+
+// play within limits
+bool ExpectimaxPlayer::Play(const GameState &state, GameState::Direction *move,
+                            const SearchLimits &limits) {
+    const uint32_t max_depth =
+            limits.depth != 0 ? std::min(limits.depth, kMaxDepth) : depth_;
+    // every move raises the largest power by at most 1, and new tiles are at
+    // most 4
+    eval::EvaluationFunction::Range range{eval::EvaluationFunction::kNegInf,
+                                          eval::EvaluationFunction::kPosInf};
+    if (prune_) {
+        const uint32_t max_power = std::max<uint32_t>(state.GetMaxPower(), 2) +
+                                   max_depth;
+        range = eval_->GetRange(state.height(), state.width(),
+                                std::min<uint32_t>(max_power, UINT8_MAX));
+    }
+    if (state.height() == BitBoard4x4::kHeight &&
+            state.width() == BitBoard4x4::kWidth &&
+            state.GetMaxPower() <= BitBoard4x4::kMaxPower)
+        return Search(BitBoard4x4(state), max_depth, range, limits, move);
+    return Search(GameState(state), max_depth, range, limits, move);
+}
+
+}  // namespace ai
+}  // namespace _2048
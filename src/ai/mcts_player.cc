@@ -0,0 +1,370 @@
+#include "ai/mcts_player.h"
+
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+
+#include "bit_board_4x4.h"
+#include "ai/thread_pool.h"
+
+namespace _2048 {
+namespace ai {
+
+namespace {
+
+// add a tile to a state after a move, as `RandomGenerator` does
+// return the key of the tile: twice its index, plus 1 for a 4
+template <typename State>
+uint32_t Spawn(State *state, std::default_random_engine *engine) {
+    const uint32_t count = state->CountEmptyTiles();
+    const uint32_t n =
+            std::uniform_int_distribution<uint32_t>(0, count - 1)(*engine);
+    const uint8_t power = std::bernoulli_distribution(0.1)(*engine) ? 2 : 1;
+    const GameState::Position pos = state->GetEmptyTile(n);
+    state->GenerateTile(pos, power);
+    return (pos.r * state->width() + pos.c) * 2 + power - 1;
+}
+
+// choose a legal move uniformly at random, as `RandomPlayer` does
+inline GameState::Direction RandomMove(GameState::DirectionMask mask,
+                                       std::default_random_engine *engine) {
+    uint32_t select = std::uniform_int_distribution<uint32_t>(
+            0, __builtin_popcount(mask) - 1)(*engine);
+    for (GameState::Direction dir : GameState::kDirections)
+        if ((mask & GameState::ToMask(dir)) && select-- == 0)
+            return dir;
+    return GameState::kDirections[0];
+}
+
+}  // namespace
+
+// constructor
+MctsPlayer::MctsPlayer(uint64_t playouts,
+                       std::chrono::milliseconds time_limit, uint32_t threads,
+                       uint64_t seed, size_t tree_mb, double exploration)
+        : MctsPlayer(nullptr, playouts, time_limit, tree_mb, exploration) {
+    if (threads != 1) {
+        own_pool_ = std::make_unique<ThreadPool>(threads);
+        pool_ = own_pool_.get();
+    }
+    CreateEngines(seed);
+}
+
+// constructor with a shared pool
+MctsPlayer::MctsPlayer(uint64_t playouts,
+                       std::chrono::milliseconds time_limit, ThreadPool &pool,
+                       uint64_t seed, size_t tree_mb, double exploration)
+        : MctsPlayer(&pool, playouts, time_limit, tree_mb, exploration) {
+    CreateEngines(seed);
+}
+
+// constructor with a pool or none
+MctsPlayer::MctsPlayer(ThreadPool *pool, uint64_t playouts,
+                       std::chrono::milliseconds time_limit, size_t tree_mb,
+                       double exploration)
+        : max_playouts_(playouts), time_limit_(time_limit),
+          exploration_(exploration), tree_(tree_mb), pool_(pool),
+          started_(0), playouts_(0), last_node_(kNone), reused_(0) {
+    if (playouts == 0 && time_limit.count() <= 0)
+        throw std::invalid_argument("no search budget");
+    if (tree_mb == 0)
+        throw std::invalid_argument("tree memory budget must be positive");
+    if (!(exploration >= 0))
+        throw std::invalid_argument("exploration constant out of range");
+}
+
+// destructor
+MctsPlayer::~MctsPlayer() noexcept { }
+
+// number of threads
+uint32_t MctsPlayer::threads() const noexcept {
+    return pool_ != nullptr ? pool_->size() : 1;
+}
+
+// create one engine per thread
+void MctsPlayer::CreateEngines(uint64_t seed) {
+    for (uint32_t i = 0; i < threads(); i++)
+        engines_.emplace_back(seed + i);
+}
+
+// make node 0 the root
+void MctsPlayer::Root(const GameState &state) {
+    // the node of `state`, if it is the last state with a new tile that the
+    // last search tried
+    uint32_t root = kNone;
+    if (last_ != nullptr && last_node_ != kNone &&
+            last_->height() == state.height() &&
+            last_->width() == state.width()) {
+        const uint32_t count = last_->CountEmptyTiles();
+        for (uint32_t i = 0; i < 2 * count && root == kNone; i++) {
+            const GameState::Position pos = last_->GetEmptyTile(i / 2);
+            GameState after(*last_);
+            after.GenerateTile(pos, i % 2 + 1);
+            if (after != state)
+                continue;
+            const uint32_t key = (pos.r * state.width() + pos.c) * 2 + i % 2;
+            for (uint32_t child = tree_[last_node_].first; child != kNone;
+                    child = tree_[child].next)
+                if (tree_[child].key == key)
+                    root = child;
+            break;
+        }
+    }
+    last_.reset();
+    last_node_ = kNone;
+
+    if (root != kNone) {
+        Keep(root);
+        reused_ = tree_.size();
+        return;
+    }
+    reused_ = 0;
+    tree_.Reset();
+    Node &node = tree_[tree_.Allocate()];
+    node.visits.store(0, std::memory_order_relaxed);
+    node.first.store(kNone, std::memory_order_relaxed);
+    node.score.store(0, std::memory_order_relaxed);
+}
+
+// keep a subtree
+void MctsPlayer::Keep(uint32_t node) {
+    // children are allocated after their parents, so in index order `node`
+    // comes first, and moving every node down to its rank never overwrites
+    // a node that is still to be moved
+    std::vector<uint32_t> nodes{node};
+    for (size_t i = 0; i < nodes.size(); i++)
+        for (uint32_t child = tree_[nodes[i]].first; child != kNone;
+                child = tree_[child].next)
+            nodes.push_back(child);
+    std::sort(nodes.begin(), nodes.end());
+    const auto rank = [&nodes](uint32_t index) {
+        if (index == kNone)
+            return kNone;
+        return static_cast<uint32_t>(
+                std::lower_bound(nodes.begin(), nodes.end(), index) -
+                nodes.begin());
+    };
+    for (uint32_t i = 0; i < nodes.size(); i++) {
+        const Node &from = tree_[nodes[i]];
+        const uint32_t visits = from.visits;
+        const uint32_t first = rank(from.first);
+        const uint64_t score = from.score;
+        const uint32_t next = i == 0 ? kNone : rank(from.next);
+        const uint32_t key = from.key;
+        Node &to = tree_[i];
+        to.visits.store(visits, std::memory_order_relaxed);
+        to.first.store(first, std::memory_order_relaxed);
+        to.score.store(score, std::memory_order_relaxed);
+        to.next = next;
+        to.key = key;
+    }
+    tree_.Truncate(nodes.size());
+}
+
+// find or add a child
+uint32_t MctsPlayer::Child(uint32_t parent, uint32_t key, bool *added) {
+    *added = false;
+    std::atomic<uint32_t> &first = tree_[parent].first;
+    uint32_t head = first.load(std::memory_order_acquire);
+    uint32_t end = kNone;       // the children from `end` on are searched
+    uint32_t fresh = kNone;
+    for (;;) {
+        for (uint32_t child = head; child != end; child = tree_[child].next)
+            if (tree_[child].key == key)
+                return child;
+        if (fresh == kNone) {
+            fresh = tree_.Allocate();
+            if (fresh == kNone)
+                return kNone;
+            Node &node = tree_[fresh];
+            node.visits.store(0, std::memory_order_relaxed);
+            node.first.store(kNone, std::memory_order_relaxed);
+            node.score.store(0, std::memory_order_relaxed);
+            node.key = key;
+        }
+        // push the child, unless another thread pushed children meanwhile
+        tree_[fresh].next = head;
+        end = head;
+        if (first.compare_exchange_weak(head, fresh,
+                                        std::memory_order_release,
+                                        std::memory_order_acquire)) {
+            *added = true;
+            return fresh;
+        }
+    }
+}
+
+// select a move by UCT
+uint32_t MctsPlayer::Select(uint32_t parent, GameState::DirectionMask mask,
+                            bool *added) {
+    *added = false;
+    const Node &node = tree_[parent];
+    const uint32_t first = node.first.load(std::memory_order_acquire);
+    GameState::DirectionMask tried = 0;
+    for (uint32_t child = first; child != kNone; child = tree_[child].next)
+        tried |= GameState::ToMask(GameState::kDirections[tree_[child].key]);
+    for (uint32_t i = 0; i < 4; i++)
+        if (mask & ~tried & GameState::ToMask(GameState::kDirections[i]))
+            return Child(parent, i, added);
+
+    // scores are compared relative to the mean score of the parent, so one
+    // exploration constant fits every stage of the game
+    const double visits = node.visits.load(std::memory_order_relaxed);
+    const double scale = std::max(
+            node.score.load(std::memory_order_relaxed) / visits, 1.0);
+    const double log_visits = std::log(visits);
+    uint32_t best = kNone;
+    double best_value = -std::numeric_limits<double>::infinity();
+    for (uint32_t child = first; child != kNone; child = tree_[child].next) {
+        const double n = tree_[child].visits.load(std::memory_order_relaxed);
+        if (n == 0)
+            return child;
+        const double value =
+                tree_[child].score.load(std::memory_order_relaxed) / n /
+                        scale +
+                exploration_ * std::sqrt(log_visits / n);
+        if (value > best_value) {
+            best_value = value;
+            best = child;
+        }
+    }
+    return best;
+}
+
+// iterate
+template <typename State>
+void MctsPlayer::Iterate(const State &root,
+                         std::default_random_engine *engine,
+                         const SearchLimits &limits) {
+    // the nodes of an iteration, with the score before each
+    std::vector<std::pair<uint32_t, uint64_t>> path;
+    while (limits.nodes == 0 ||
+           started_.fetch_add(1, std::memory_order_relaxed) < limits.nodes) {
+        if (limits.Expired(Clock::now()))
+            break;
+        State state(root);
+        uint64_t score = 0;
+        path.clear();
+
+        // walk down to a new node, counting every node as visited at once
+        uint32_t node = 0;
+        tree_[node].visits.fetch_add(1, std::memory_order_relaxed);
+        path.emplace_back(node, score);
+        for (;;) {
+            const GameState::DirectionMask mask = state.GetPossibleMoveMask();
+            if (mask == 0)
+                break;
+            bool added;
+            const uint32_t after = Select(node, mask, &added);
+            if (after == kNone)
+                break;
+            tree_[after].visits.fetch_add(1, std::memory_order_relaxed);
+            path.emplace_back(after, score);
+            score += state.Move(
+                    GameState::kDirections[tree_[after].key]).score;
+            const uint32_t key = Spawn(&state, engine);
+            if (added)
+                break;
+            node = Child(after, key, &added);
+            if (node == kNone)
+                break;
+            tree_[node].visits.fetch_add(1, std::memory_order_relaxed);
+            path.emplace_back(node, score);
+            if (added)
+                break;
+        }
+
+        // play out, and add the score to the path
+        for (GameState::DirectionMask mask = state.GetPossibleMoveMask();
+                mask != 0; mask = state.GetPossibleMoveMask()) {
+            score += state.Move(RandomMove(mask, engine)).score;
+            Spawn(&state, engine);
+        }
+        for (const auto &[visited, before] : path)
+            tree_[visited].score.fetch_add(score - before,
+                                           std::memory_order_relaxed);
+        playouts_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// search
+template <typename State>
+uint32_t MctsPlayer::Search(const State &state, const SearchLimits &limits,
+                            GameState::Direction *move) {
+    const Node &root = tree_[0];
+    started_ = 0;
+    playouts_ = 0;
+
+    // the tighter of the limits of the player and of the play
+    SearchLimits bounds = limits;
+    if (time_limit_.count() > 0)
+        bounds.deadline = std::min(bounds.deadline,
+                                   Clock::now() + time_limit_);
+    if (max_playouts_ != 0)
+        bounds.nodes = limits.nodes != 0 ?
+                       std::min(limits.nodes, max_playouts_) : max_playouts_;
+    if (pool_ != nullptr)
+        pool_->Run(pool_->size(), [&](uint32_t thread, uint32_t task) {
+            Iterate(state, &engines_[task], bounds);
+        });
+    else
+        Iterate(state, &engines_[0], bounds);
+
+    // the most visited move, the first in `kDirections` order on ties
+    uint32_t best = kNone;
+    for (uint32_t child = root.first; child != kNone;
+            child = tree_[child].next)
+        if (best == kNone || tree_[child].visits > tree_[best].visits ||
+                (tree_[child].visits == tree_[best].visits &&
+                 tree_[child].key < tree_[best].key))
+            best = child;
+    if (best != kNone) {
+        *move = GameState::kDirections[tree_[best].key];
+        return best;
+    }
+    // no iteration got to try a move
+    const GameState::DirectionMask mask = state.GetPossibleMoveMask();
+    for (GameState::Direction dir : GameState::kDirections)
+        if (mask & GameState::ToMask(dir)) {
+            *move = dir;
+            break;
+        }
+    return kNone;
+}
+
+// play
+bool MctsPlayer::Play(const GameState &state, GameState::Direction *move) {
+    return Play(state, move, SearchLimits());
+}
+
+// play within limits
+bool MctsPlayer::Play(const GameState &state, GameState::Direction *move,
+                      const SearchLimits &limits) {
+    if (state.GetPossibleMoveMask() == 0)
+        return false;
+    Root(state);
+    GameState::Direction best;
+    uint32_t node;
+    if (state.height() == BitBoard4x4::kHeight &&
+            state.width() == BitBoard4x4::kWidth &&
+            state.GetMaxPower() <= BitBoard4x4::kMaxPower)
+        node = Search(BitBoard4x4(state), limits, &best);
+    else
+        node = Search(state, limits, &best);
+    last_ = std::make_unique<GameState>(state);
+    last_->Move(best);
+    last_node_ = node;
+    if (move != nullptr)
+        *move = best;
+    return true;
+}
+
+}  // namespace ai
+}  // namespace _2048
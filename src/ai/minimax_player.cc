@@ -0,0 +1,316 @@
+#include "ai/minimax_player.h"
+
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+
+#include "bit_board_4x4.h"
+
+namespace _2048 {
+namespace ai {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using eval::EvaluationFunction;
+
+// nodes between two checks of the limits
+constexpr uint64_t kClockInterval = 1024;
+
+// mixed into the keys of generator nodes, which may share a board with a
+// player node
+constexpr uint64_t kMinKey = 0x9E3779B97F4A7C15;
+
+using Table = MinimaxPlayer::Table;
+
+// alpha-beta minimax over a game state of type `State`
+// each ply owns one undo record, so records are reused across the search
+template <typename State>
+class AlphaBeta {
+ public:
+    // the depth of `limits` is not used
+    AlphaBeta(const EvaluationFunction &eval, uint32_t max_depth,
+              Table *table, const SearchLimits &limits)
+            : eval_(eval), undos_(2 * max_depth), killers_(2 * max_depth, 0),
+              table_(*table), limits_(limits), interruptible_(false),
+              expired_(false), nodes_(0) { }
+
+    uint64_t nodes() const noexcept { return nodes_; }
+    bool expired() const noexcept { return expired_; }
+
+    // whether the next iteration may be interrupted by the limits
+    void set_interruptible(bool interruptible) noexcept {
+        interruptible_ = interruptible;
+    }
+
+    // value of the root after `dir`, searched `depth` moves deep in total
+    int64_t Root(State *state, GameState::Direction dir, uint32_t depth,
+                 int64_t alpha, int64_t beta) {
+        state->Move(dir, &undos_[0]);
+        const int64_t value = Min(state, depth, alpha, beta, 1);
+        state->Undo(undos_[0]);
+        return value;
+    }
+
+ private:
+    const EvaluationFunction &eval_;
+    std::vector<typename State::UndoRecord> undos_;
+    std::vector<uint32_t> killers_;
+    Table &table_;
+    SearchLimits limits_;
+    bool interruptible_;
+    bool expired_;
+    uint64_t nodes_;
+
+    // count a node, and check the limits every `kClockInterval` nodes
+    bool Visit() {
+        if (++nodes_ % kClockInterval == 0 && interruptible_ &&
+                ((limits_.nodes != 0 && nodes_ >= limits_.nodes) ||
+                 limits_.Expired(Clock::now())))
+            expired_ = true;
+        return !expired_;
+    }
+
+    // look up a node searched to `depth` before
+    // return true if the stored value decides the node within the window
+    // otherwise set `first` to the stored best child, if any
+    bool Probe(uint64_t key, uint32_t depth, int64_t alpha, int64_t beta,
+               int64_t *value, uint32_t *first) {
+        Table::Entry entry;
+        if (!table_.Probe(key, &entry))
+            return false;
+        const bool cuts =
+                entry.bound == Table::Bound::EXACT ||
+                (entry.bound == Table::Bound::LOWER && entry.value >= beta) ||
+                (entry.bound == Table::Bound::UPPER && entry.value <= alpha);
+        if (entry.depth == depth && cuts) {
+            *value = entry.value;
+            return true;
+        }
+        if (entry.move != Table::kNoMove)
+            *first = entry.move;
+        return false;
+    }
+
+    // store the result of a node searched with the window (alpha, beta)
+    void Store(uint64_t key, uint32_t depth, int64_t alpha, int64_t beta,
+               int64_t value, uint32_t best) {
+        const Table::Bound bound = value <= alpha ? Table::Bound::UPPER :
+                                   value >= beta ? Table::Bound::LOWER :
+                                   Table::Bound::EXACT;
+        const uint8_t move = best < Table::kNoMove ? best : Table::kNoMove;
+        table_.Store(key, Table::Entry{value, static_cast<uint8_t>(depth),
+                                       bound, move});
+    }
+
+    // value of a player node with `depth` moves left
+    int64_t Max(State *state, uint32_t depth, int64_t alpha, int64_t beta,
+                uint32_t ply) {
+        if (!Visit())
+            return 0;
+        if (depth == 0)
+            return eval_(*state);
+
+        // try the best move of an earlier search first, before finding the
+        // other legal moves, which are found by moving
+        const uint64_t key = state->Hash();
+        int64_t value;
+        uint32_t first = 0;
+        if (Probe(key, depth, alpha, beta, &value, &first))
+            return value;
+        if (first >= 4)
+            first = 0;
+        const int64_t alpha0 = alpha;
+        value = EvaluationFunction::kNegInf;
+        uint32_t best = first;
+        bool moved = false;
+        for (uint32_t k = 0; k < 4; k++) {
+            const uint32_t i = k == 0 ? first : (k == first ? 0 : k);
+            const GameState::Direction dir = GameState::kDirections[i];
+            if (!state->Move(dir, &undos_[ply]).moved) {
+                state->Undo(undos_[ply]);
+                continue;
+            }
+            moved = true;
+            const int64_t child = Min(state, depth, alpha, beta, ply + 1);
+            state->Undo(undos_[ply]);
+            if (expired_)
+                return 0;
+            if (child > value) {
+                value = child;
+                best = i;
+            }
+            alpha = std::max(alpha, value);
+            if (alpha >= beta)
+                break;
+        }
+        if (!moved)
+            return EvaluationFunction::kOver;
+        Store(key, depth, alpha0, beta, value, best);
+        return value;
+    }
+
+    // value of a generator node, whose player children have `depth - 1`
+    // moves left
+    int64_t Min(State *state, uint32_t depth, int64_t alpha, int64_t beta,
+                uint32_t ply) {
+        if (!Visit())
+            return 0;
+        const uint32_t count = state->CountEmptyTiles();
+        if (count == 0)
+            return Max(state, depth - 1, alpha, beta, ply);
+
+        // children are (empty tile, power) pairs, numbered 2 * tile + power - 1
+        // try the best spawn of an earlier search first
+        const uint64_t key = state->Hash() ^ kMinKey;
+        int64_t value;
+        uint32_t first = 0;
+        if (Probe(key, depth, alpha, beta, &value, &first))
+            return value;
+        if (first >= 2 * count)
+            first = 0;
+
+        // then the spawn that last cut off a sibling, by its number
+        uint32_t second = killers_[ply];
+        if (second >= 2 * count || second == first)
+            second = first;
+        const int64_t beta0 = beta;
+        value = EvaluationFunction::kPosInf;
+        uint32_t best = first;
+        for (uint32_t k = 0; k < 2 * count + 2; k++) {
+            const uint32_t i = k == 0 ? first : k == 1 ? second : k - 2;
+            if ((k == 1 && second == first) ||
+                    (k >= 2 && (i == first || i == second)))
+                continue;
+            state->GenerateTile(state->GetEmptyTile(i / 2), i % 2 + 1,
+                                &undos_[ply]);
+            const int64_t child = Max(state, depth - 1, alpha, beta, ply + 1);
+            state->Undo(undos_[ply]);
+            if (expired_)
+                return 0;
+            if (child < value) {
+                value = child;
+                best = i;
+            }
+            beta = std::min(beta, value);
+            if (alpha >= beta) {
+                killers_[ply] = i;
+                break;
+            }
+        }
+        Store(key, depth, alpha, beta0, value, best);
+        return value;
+    }
+};
+
+}  // namespace
+
+// constructor
+MinimaxPlayer::MinimaxPlayer(const eval::EvaluationFunction *eval,
+                             uint32_t max_depth,
+                             std::chrono::milliseconds time_limit,
+                             size_t table_mb)
+        : eval_(eval), max_depth_(max_depth), time_limit_(time_limit),
+          table_(table_mb), depth_(0), value_(0), nodes_(0), reused_(0),
+          seconds_(0) {
+    if (eval == nullptr)
+        throw std::invalid_argument("null evaluation function");
+    if (max_depth == 0)
+        throw std::invalid_argument("search depth must be positive");
+    if (max_depth > kMaxDepth)
+        throw std::invalid_argument("search depth too large");
+}
+
+// search
+template <typename State>
+bool MinimaxPlayer::Search(State state, const SearchLimits &limits,
+                           GameState::Direction *move) {
+    const Clock::time_point start = Clock::now();
+    SearchLimits bounds = limits;
+    if (time_limit_.count() > 0)
+        bounds.deadline = std::min(bounds.deadline, start + time_limit_);
+    const uint32_t max_depth =
+            limits.depth != 0 ? std::min(limits.depth, kMaxDepth) : max_depth_;
+    depth_ = 0;
+    value_ = 0;
+    nodes_ = 0;
+    reused_ = 0;
+    seconds_ = 0;
+
+    // root moves, ordered by the values of the previous iteration
+    struct RootMove {
+        GameState::Direction dir;
+        int64_t value;
+    };
+    std::vector<RootMove> moves;
+    const GameState::DirectionMask mask = state.GetPossibleMoveMask();
+    for (GameState::Direction dir : GameState::kDirections)
+        if (mask & GameState::ToMask(dir))
+            moves.push_back(RootMove{dir, 0});
+    if (moves.empty())
+        return false;
+    if (moves.size() == 1) {
+        if (move != nullptr)
+            *move = moves[0].dir;
+        return true;
+    }
+
+    table_.NewSearch();
+    const uint64_t reused = table_.stats().reused;
+    AlphaBeta<State> search(*eval_, max_depth, &table_, bounds);
+    GameState::Direction best = moves[0].dir;
+    for (uint32_t depth = 1; depth <= max_depth; depth++) {
+        search.set_interruptible(depth > 1);
+        std::vector<RootMove> values(moves);
+        int64_t alpha = eval::EvaluationFunction::kNegInf;
+        for (RootMove &root : values) {
+            // a move that cannot beat alpha only gets an upper bound, which
+            // still orders it after the better moves
+            root.value = search.Root(&state, root.dir, depth, alpha,
+                                     eval::EvaluationFunction::kPosInf);
+            if (search.expired())
+                break;
+            alpha = std::max(alpha, root.value);
+        }
+        if (search.expired())
+            break;
+
+        std::stable_sort(values.begin(), values.end(),
+                         [](const RootMove &a, const RootMove &b) {
+                             return a.value > b.value;
+                         });
+        moves = values;
+        best = moves[0].dir;
+        depth_ = depth;
+        value_ = moves[0].value;
+        if (value_ == eval::EvaluationFunction::kOver)
+            break;
+    }
+
+    nodes_ = search.nodes();
+    reused_ = table_.stats().reused - reused;
+    seconds_ = std::chrono::duration<double>(Clock::now() - start).count();
+    if (move != nullptr)
+        *move = best;
+    return true;
+}
+
+// play
+bool MinimaxPlayer::Play(const GameState &state, GameState::Direction *move) {
+    return Play(state, move, SearchLimits());
+}
+
+// play within limits
+bool MinimaxPlayer::Play(const GameState &state, GameState::Direction *move,
+                         const SearchLimits &limits) {
+    if (state.height() == BitBoard4x4::kHeight &&
+            state.width() == BitBoard4x4::kWidth &&
+            state.GetMaxPower() <= BitBoard4x4::kMaxPower)
+        return Search(BitBoard4x4(state), limits, move);
+    return Search(GameState(state), limits, move);
+}
+
+}  // namespace ai
+}  // namespace _2048
@@ -0,0 +1,99 @@
+#include "ai/pondering_player.h"
+
+#include <cstdint>
+#include <thread>
+#include <utility>
+#include <stdexcept>
+
+namespace _2048 {
+namespace ai {
+
+// constructor
+PonderingPlayer::PonderingPlayer(Player *player)
+        : player_(player), stop_(false), hits_(0), misses_(0) {
+    if (player == nullptr)
+        throw std::invalid_argument("null player");
+}
+
+// destructor
+PonderingPlayer::~PonderingPlayer() noexcept {
+    Stop();
+}
+
+// stop pondering
+void PonderingPlayer::Stop() noexcept {
+    stop_ = true;
+    if (thread_.joinable())
+        thread_.join();
+}
+
+// wait for pondering
+void PonderingPlayer::Wait() noexcept {
+    if (thread_.joinable())
+        thread_.join();
+}
+
+// play
+bool PonderingPlayer::Play(const GameState &state,
+                           GameState::Direction *move) {
+    return Play(state, move, SearchLimits());
+}
+
+// play within limits
+bool PonderingPlayer::Play(const GameState &state, GameState::Direction *move,
+                           const SearchLimits &limits) {
+    Stop();
+    bool played = false;
+    GameState::Direction best = GameState::Direction::UP;
+    bool found = false;
+    if (limits.nodes == 0 && limits.depth == 0)
+        for (const Answer &answer : answers_)
+            if (answer.state == state) {
+                played = answer.played;
+                best = answer.move;
+                found = true;
+                break;
+            }
+    answers_.clear();
+    if (found) {
+        hits_++;
+    } else {
+        misses_++;
+        played = player_->Play(state, &best, limits);
+    }
+    if (!played)
+        return false;
+    if (move != nullptr)
+        *move = best;
+
+    GameState after(state);
+    after.Move(best);
+    stop_ = false;
+    thread_ = std::thread(&PonderingPlayer::Ponder, this, std::move(after));
+    return true;
+}
+
+// ponder
+void PonderingPlayer::Ponder(GameState after) {
+    SearchLimits limits;
+    limits.stop = &stop_;
+    const uint32_t count = after.CountEmptyTiles();
+    try {
+        for (uint8_t power = 1; power <= 2; power++)
+            for (uint32_t i = 0; i < count; i++) {
+                GameState state(after);
+                state.GenerateTile(after.GetEmptyTile(i), power);
+                GameState::Direction move = GameState::Direction::UP;
+                const bool played = player_->Play(state, &move, limits);
+                // a stopped search may not have searched as deep as `Play`
+                if (stop_)
+                    return;
+                answers_.push_back(Answer{std::move(state), played, move});
+            }
+    } catch (...) {
+        return;
+    }
+}
+
+}  // namespace ai
+}  // namespace _2048
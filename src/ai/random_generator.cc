@@ -9,12 +9,12 @@ namespace ai {
 bool RandomGenerator::Generate(const GameState &state, GameState::Position *pos,
                                uint8_t *power) {
     if (pos != nullptr) {
-        auto choices = state.GetEmptyTiles();
-        if (choices.empty())
+        uint32_t choices = state.CountEmptyTiles();
+        if (choices == 0)
             return false;
-        auto select = std::uniform_int_distribution<
-                decltype(choices)::size_type>(0, choices.size() - 1)(engine_);
-        *pos = choices[select];
+        auto select = std::uniform_int_distribution<uint32_t>(
+                0, choices - 1)(engine_);
+        *pos = state.GetEmptyTile(select);
     }
     if (power != nullptr) {
         *power = std::bernoulli_distribution(0.1)(engine_) ? 2 : 1;
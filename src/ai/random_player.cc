@@ -6,12 +6,14 @@ namespace ai {
 // play
 bool RandomPlayer::Play(const GameState &state, GameState::Direction *move) {
     if (move != nullptr) {
-        auto choices = state.GetPossibleMoves();
-        if (choices.empty())
+        GameState::DirectionMask choices = state.GetPossibleMoveMask();
+        if (choices == 0)
             return false;
-        auto select = std::uniform_int_distribution<
-                decltype(choices)::size_type>(0, choices.size() - 1)(engine_);
-        *move = choices[select];
+        auto select = std::uniform_int_distribution<uint32_t>(
+                0, __builtin_popcount(choices) - 1)(engine_);
+        for (GameState::Direction dir : GameState::kDirections)
+            if ((choices & GameState::ToMask(dir)) && select-- == 0)
+                *move = dir;
     }
     return true;
 }
@@ -0,0 +1,242 @@
+#include "ai/rollout_player.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <stdexcept>
+
+#include "bit_board_4x4.h"
+#include "ai/thread_pool.h"
+
+namespace _2048 {
+namespace ai {
+
+namespace {
+
+using Clock = SearchLimits::Clock;
+
+// the 24 orders of the 4 directions
+constexpr uint8_t kOrders[24][4] = {
+    {0, 1, 2, 3}, {0, 1, 3, 2}, {0, 2, 1, 3}, {0, 2, 3, 1}, {0, 3, 1, 2},
+    {0, 3, 2, 1}, {1, 0, 2, 3}, {1, 0, 3, 2}, {1, 2, 0, 3}, {1, 2, 3, 0},
+    {1, 3, 0, 2}, {1, 3, 2, 0}, {2, 0, 1, 3}, {2, 0, 3, 1}, {2, 1, 0, 3},
+    {2, 1, 3, 0}, {2, 3, 0, 1}, {2, 3, 1, 0}, {3, 0, 1, 2}, {3, 0, 2, 1},
+    {3, 1, 0, 2}, {3, 1, 2, 0}, {3, 2, 0, 1}, {3, 2, 1, 0}
+};
+
+// mix a number into a seed
+inline uint64_t Mix(uint64_t x) noexcept {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EB;
+    return x ^ (x >> 31);
+}
+
+// xorshift64*, small and fast enough to draw a number for every move
+class Xorshift {
+ public:
+    explicit Xorshift(uint64_t seed) noexcept
+            : state_(seed != 0 ? seed : 0x9E3779B97F4A7C15) { }
+
+    uint64_t operator()() noexcept {
+        state_ ^= state_ >> 12;
+        state_ ^= state_ << 25;
+        state_ ^= state_ >> 27;
+        return state_ * 0x2545F4914F6CDD1D;
+    }
+
+ private:
+    uint64_t state_;
+};
+
+// a number in [0, n) from 16 random bits
+inline uint32_t Below(uint64_t bits, uint32_t n) noexcept {
+    return static_cast<uint32_t>(((bits & 0xFFFF) * n) >> 16);
+}
+
+// add `power` on the `n`-th empty tile of a board with an empty tile
+inline void Spawn(BitBoard4x4 *board, uint32_t n, uint8_t power) noexcept {
+    uint64_t empty = board->EmptyNibbles();
+    for (; n > 0; n--)
+        empty &= empty - 1;
+    const uint64_t tile = static_cast<uint64_t>(power)
+                          << __builtin_ctzll(empty);
+    *board = BitBoard4x4(board->raw() | tile);
+}
+
+inline void Spawn(GameState *state, uint32_t n, uint8_t power) {
+    state->GenerateTile(state->GetEmptyTile(n), power);
+}
+
+// play a random game from a state after a move to the end
+// add the score gained to `score`, and return the number of moves
+template <typename State>
+uint64_t Rollout(State state, Xorshift *engine, uint64_t *score) {
+    for (uint64_t moves = 0; ; moves++) {
+        // 16 bits each for the tile, its power and the order of the moves;
+        // a tile is a 4 with probability 6554 / 65536, close to 0.1
+        const uint64_t bits = (*engine)();
+        Spawn(&state, Below(bits, state.CountEmptyTiles()),
+              (bits >> 16 & 0xFFFF) < 6554 ? 2 : 1);
+
+        // the first legal move in a random order is a uniformly random
+        // legal move, without finding all legal moves first
+        const uint8_t *order = kOrders[Below(bits >> 32, 24)];
+        bool moved = false;
+        for (uint32_t k = 0; k < 4 && !moved; k++) {
+            const GameState::MoveResult result =
+                    state.Move(static_cast<GameState::Direction>(order[k]));
+            moved = result.moved;
+            *score += result.score;
+        }
+        if (!moved)
+            return moves;
+    }
+}
+
+}  // namespace
+
+// constructor
+RolloutPlayer::RolloutPlayer(uint32_t rollouts, Objective objective,
+                             uint32_t threads, uint64_t seed)
+        : RolloutPlayer(nullptr, rollouts, objective, seed) {
+    if (threads != 1) {
+        own_pool_ = std::make_unique<ThreadPool>(threads);
+        pool_ = own_pool_.get();
+    }
+}
+
+// constructor with a shared pool
+RolloutPlayer::RolloutPlayer(uint32_t rollouts, Objective objective,
+                             ThreadPool &pool, uint64_t seed)
+        : RolloutPlayer(&pool, rollouts, objective, seed) { }
+
+// constructor with a pool or none
+RolloutPlayer::RolloutPlayer(ThreadPool *pool, uint32_t rollouts,
+                             Objective objective, uint64_t seed)
+        : max_rollouts_(rollouts), objective_(objective), seed_(seed),
+          pool_(pool), plays_(0), rollouts_(0), moves_(0), seconds_(0) {
+    if (rollouts == 0)
+        throw std::invalid_argument("number of rollouts must be positive");
+}
+
+// destructor
+RolloutPlayer::~RolloutPlayer() noexcept { }
+
+// number of threads
+uint32_t RolloutPlayer::threads() const noexcept {
+    return pool_ != nullptr ? pool_->size() : 1;
+}
+
+// search
+template <typename State>
+GameState::Direction RolloutPlayer::Search(const State &state,
+                                           const SearchLimits &limits) {
+    const Clock::time_point start = Clock::now();
+    plays_++;
+
+    // the states after the legal moves, with the scores of the moves
+    std::vector<GameState::Direction> dirs;
+    std::vector<State> children;
+    std::vector<uint64_t> scores;
+    const GameState::DirectionMask mask = state.GetPossibleMoveMask();
+    for (GameState::Direction dir : GameState::kDirections)
+        if (mask & GameState::ToMask(dir)) {
+            dirs.push_back(dir);
+            children.push_back(state);
+            scores.push_back(children.back().Move(dir).score);
+        }
+
+    // a node limit caps the games of all moves together
+    uint64_t rollouts = max_rollouts_;
+    if (limits.nodes != 0)
+        rollouts = std::clamp<uint64_t>(limits.nodes / dirs.size(), 1,
+                                         rollouts);
+    const uint32_t batches = (rollouts + kBatch - 1) / kBatch;
+
+    // totals of each batch, which are added up in order
+    struct Totals {
+        uint64_t rollouts = 0;
+        uint64_t moves = 0;
+        uint64_t score = 0;
+    };
+    std::vector<Totals> totals(dirs.size() * batches);
+    const bool limited = limits.deadline != Clock::time_point::max() ||
+                         limits.stop != nullptr;
+    const auto run = [&](uint32_t thread, uint32_t task) {
+        const uint32_t child = task / batches;
+        const uint64_t begin = task % batches * uint64_t(kBatch);
+        const uint64_t end = std::min<uint64_t>(begin + kBatch, rollouts);
+        Xorshift engine(Mix(seed_ ^ Mix(plays_ * 4 + static_cast<uint32_t>(
+                dirs[child])) ^ Mix(begin)));
+        Totals &sum = totals[task];
+        for (uint64_t i = begin; i < end; i++) {
+            // every batch plays at least one game, so every move has one
+            if (i > begin && limited && limits.Expired(Clock::now()))
+                break;
+            sum.moves += Rollout(children[child], &engine, &sum.score);
+            sum.rollouts++;
+        }
+    };
+    if (pool_ != nullptr)
+        pool_->Run(totals.size(), run);
+    else
+        for (uint32_t task = 0; task < totals.size(); task++)
+            run(0, task);
+
+    // the move with the best mean
+    GameState::Direction best = dirs[0];
+    double best_mean = -std::numeric_limits<double>::infinity();
+    for (uint32_t child = 0; child < dirs.size(); child++) {
+        Totals sum;
+        for (uint32_t batch = 0; batch < batches; batch++) {
+            const Totals &part = totals[child * batches + batch];
+            sum.rollouts += part.rollouts;
+            sum.moves += part.moves;
+            sum.score += part.score;
+        }
+        rollouts_ += sum.rollouts;
+        moves_ += sum.moves;
+        const double mean = objective_ == Objective::SCORE ?
+                            scores[child] + double(sum.score) / sum.rollouts :
+                            double(sum.moves) / sum.rollouts;
+        if (mean > best_mean) {
+            best_mean = mean;
+            best = dirs[child];
+        }
+    }
+    seconds_ = std::chrono::duration<double>(Clock::now() - start).count();
+    return best;
+}
+
+// play
+bool RolloutPlayer::Play(const GameState &state, GameState::Direction *move) {
+    return Play(state, move, SearchLimits());
+}
+
+// play within limits
+bool RolloutPlayer::Play(const GameState &state, GameState::Direction *move,
+                         const SearchLimits &limits) {
+    rollouts_ = 0;
+    moves_ = 0;
+    seconds_ = 0;
+    if (state.GetPossibleMoveMask() == 0)
+        return false;
+    GameState::Direction best;
+    if (state.height() == BitBoard4x4::kHeight &&
+            state.width() == BitBoard4x4::kWidth &&
+            state.GetMaxPower() <= BitBoard4x4::kMaxPower)
+        best = Search(BitBoard4x4(state), limits);
+    else
+        best = Search(GameState(state), limits);
+    if (move != nullptr)
+        *move = best;
+    return true;
+}
+
+}  // namespace ai
+}  // namespace _2048
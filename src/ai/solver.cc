@@ -0,0 +1,228 @@
+#include "ai/solver.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdexcept>
+
+namespace _2048 {
+namespace ai {
+
+namespace {
+
+// probabilities of a 2 and of a 4, as in `RandomGenerator`
+constexpr double kProbability[3] = {0, 0.9, 0.1};
+
+// moves on the packed keys of one board size
+class Mover {
+ public:
+    Mover(uint32_t height, uint32_t width) {
+        // the tiles of every line, from the one the line moves towards
+        for (uint32_t c = 0; c < width; c++) {
+            std::vector<uint8_t> up, down;
+            for (uint32_t r = 0; r < height; r++) {
+                up.push_back(r * width + c);
+                down.push_back((height - 1 - r) * width + c);
+            }
+            lines_[Index(GameState::Direction::UP)].push_back(up);
+            lines_[Index(GameState::Direction::DOWN)].push_back(down);
+        }
+        for (uint32_t r = 0; r < height; r++) {
+            std::vector<uint8_t> left, right;
+            for (uint32_t c = 0; c < width; c++) {
+                left.push_back(r * width + c);
+                right.push_back(r * width + width - 1 - c);
+            }
+            lines_[Index(GameState::Direction::LEFT)].push_back(left);
+            lines_[Index(GameState::Direction::RIGHT)].push_back(right);
+        }
+    }
+
+    // move a key, and return false if no tile moves
+    // boards of at most `Solver::kMaxTiles` tiles never merge two 15s
+    bool Move(uint64_t key, GameState::Direction dir, uint64_t *after,
+              uint64_t *score) const noexcept {
+        uint64_t moved = key;
+        *score = 0;
+        for (const std::vector<uint8_t> &line : lines_[Index(dir)]) {
+            uint8_t powers[Solver::kMaxTiles];
+            uint32_t count = 0;
+            bool merged = false;
+            for (uint8_t tile : line) {
+                const uint8_t power = key >> 4 * tile & 0xF;
+                if (power == 0)
+                    continue;
+                if (count > 0 && !merged && powers[count - 1] == power) {
+                    powers[count - 1]++;
+                    *score += uint64_t(1) << (power + 1);
+                    merged = true;
+                } else {
+                    powers[count++] = power;
+                    merged = false;
+                }
+            }
+            for (uint32_t i = 0; i < line.size(); i++) {
+                moved &= ~(uint64_t(0xF) << 4 * line[i]);
+                if (i < count)
+                    moved |= uint64_t(powers[i]) << 4 * line[i];
+            }
+        }
+        *after = moved;
+        return moved != key;
+    }
+
+ private:
+    std::vector<std::vector<uint8_t>> lines_[4];
+
+    static constexpr uint32_t Index(GameState::Direction dir) noexcept {
+        return static_cast<uint32_t>(dir);
+    }
+};
+
+// sum of the tiles of a key, in 2s
+inline uint32_t Sum(uint64_t key) noexcept {
+    uint32_t sum = 0;
+    for (; key != 0; key >>= 4)
+        if ((key & 0xF) != 0)
+            sum += 1 << ((key & 0xF) - 1);
+    return sum;
+}
+
+// positions after a move with one sum of tiles
+struct Layer {
+    std::vector<uint64_t> keys;     // sorted and unique once complete
+    size_t unique = 0;              // size after the last compaction
+    std::vector<double> values;
+
+    // add a key, and drop duplicates whenever the keys have doubled
+    void Add(uint64_t key) {
+        keys.push_back(key);
+        if (keys.size() >= 2 * unique + (1 << 20))
+            Compact();
+    }
+
+    void Compact() {
+        std::sort(keys.begin(), keys.end());
+        keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+        keys.shrink_to_fit();
+        unique = keys.size();
+    }
+
+    double Find(uint64_t key) const noexcept {
+        return values[std::lower_bound(keys.begin(), keys.end(), key) -
+                      keys.begin()];
+    }
+};
+
+}  // namespace
+
+// constructor
+Solver::Solver(uint32_t height, uint32_t width, Objective objective)
+        : height_(height), width_(width), objective_(objective),
+          start_value_(0) {
+    if (height == 0 || width == 0 || height * width < 2 ||
+            height * width > kMaxTiles)
+        throw std::invalid_argument("board size out of range");
+    const uint32_t tiles = height * width;
+    const TableKeys table_keys(height, width);
+    const Mover mover(height, width);
+    std::vector<Layer> layers(5);
+
+    // the positions after each move from a position with a sum of tiles
+    const auto expand = [&](uint64_t key, uint32_t sum) {
+        for (GameState::Direction dir : GameState::kDirections) {
+            uint64_t after, score;
+            if (mover.Move(key, dir, &after, &score))
+                layers[sum].Add(table_keys.Canonical(after));
+        }
+    };
+
+    // the best value of a position with a sum of tiles before a move, from
+    // the values of the positions after it
+    const auto best = [&](uint64_t key, uint32_t sum) {
+        double value = 0;
+        for (GameState::Direction dir : GameState::kDirections) {
+            uint64_t after, score;
+            if (mover.Move(key, dir, &after, &score))
+                value = std::max(value,
+                                 (objective == Objective::MOVES ? 1 : score) +
+                                 layers[sum].Find(table_keys.Canonical(after)));
+        }
+        return value;
+    };
+
+    // enumerate from the boards with one or two tiles, one sum at a time
+    for (uint32_t i = 0; i < tiles; i++)
+        for (uint64_t p = 1; p <= 2; p++) {
+            expand(p << 4 * i, p);
+            for (uint32_t j = i + 1; j < tiles; j++)
+                for (uint64_t q = 1; q <= 2; q++)
+                    expand(p << 4 * i | q << 4 * j, p + q);
+        }
+    for (uint32_t sum = 0; sum < layers.size(); sum++) {
+        layers[sum].Compact();
+        if (layers[sum].keys.empty())
+            continue;
+        if (layers.size() < sum + 3)
+            layers.resize(sum + 3);
+        for (uint64_t key : layers[sum].keys)
+            for (uint32_t i = 0; i < tiles; i++)
+                if ((key >> 4 * i & 0xF) == 0)
+                    for (uint64_t p = 1; p <= 2; p++)
+                        expand(key | p << 4 * i, sum + p);
+    }
+
+    // value from the largest sum down
+    for (uint32_t sum = layers.size(); sum-- > 0;) {
+        Layer &layer = layers[sum];
+        layer.values.resize(layer.keys.size());
+        for (size_t k = 0; k < layer.keys.size(); k++) {
+            const uint64_t key = layer.keys[k];
+            uint32_t count = 0;
+            double value = 0;
+            for (uint32_t i = 0; i < tiles; i++)
+                if ((key >> 4 * i & 0xF) == 0) {
+                    count++;
+                    for (uint64_t p = 1; p <= 2; p++)
+                        value += kProbability[p] *
+                                 best(key | p << 4 * i, sum + p);
+                }
+            layer.values[k] = count > 0 ? value / count : 0;
+        }
+    }
+
+    // a new game gets two tiles before the first move
+    for (uint32_t i = 0; i < tiles; i++)
+        for (uint64_t p = 1; p <= 2; p++)
+            for (uint32_t j = 0; j < tiles; j++)
+                for (uint64_t q = 1; q <= 2; q++)
+                    if (j != i)
+                        start_value_ += kProbability[p] * kProbability[q] *
+                                        best(p << 4 * i | q << 4 * j, p + q);
+    start_value_ /= tiles * (tiles - 1);
+
+    // all positions in one sorted table
+    std::vector<std::pair<uint64_t, double>> all;
+    for (Layer &layer : layers) {
+        for (size_t k = 0; k < layer.keys.size(); k++)
+            all.emplace_back(layer.keys[k], layer.values[k]);
+        layer = Layer();
+    }
+    std::sort(all.begin(), all.end());
+    keys_.reserve(all.size());
+    values_.reserve(all.size());
+    for (const auto &[key, value] : all) {
+        keys_.push_back(key);
+        values_.push_back(value);
+    }
+}
+
+// write
+void Solver::Write(const std::string &path) const {
+    ValueTable::Write(path, height_, width_, objective_, keys_, values_);
+}
+
+}  // namespace ai
+}  // namespace _2048
@@ -0,0 +1,45 @@
+#include "ai/table_player.h"
+
+#include <string>
+#include <stdexcept>
+
+namespace _2048 {
+namespace ai {
+
+// constructor
+TablePlayer::TablePlayer(const std::string &path)
+        : table_(path), keys_(table_.height(), table_.width()), value_(0) { }
+
+// play
+bool TablePlayer::Play(const GameState &state, GameState::Direction *move) {
+    if (state.height() != table_.height() || state.width() != table_.width())
+        throw std::invalid_argument("game state size mismatch");
+    value_ = 0;
+    const GameState::DirectionMask mask = state.GetPossibleMoveMask();
+    if (mask == 0)
+        return false;
+    GameState::Direction best = GameState::kDirections[0];
+    double best_value = -1;
+    for (GameState::Direction dir : GameState::kDirections) {
+        if (!(mask & GameState::ToMask(dir)))
+            continue;
+        GameState after(state);
+        const GameState::MoveResult result = after.Move(dir);
+        double value;
+        if (!table_.Find(keys_.Canonical(keys_.Pack(after)), &value))
+            throw std::out_of_range("position not in value table");
+        value += table_.objective() == ValueTable::Objective::MOVES ?
+                 1 : result.score;
+        if (value > best_value) {
+            best_value = value;
+            best = dir;
+        }
+    }
+    value_ = best_value;
+    if (move != nullptr)
+        *move = best;
+    return true;
+}
+
+}  // namespace ai
+}  // namespace _2048
@@ -0,0 +1,155 @@
+#include "ai/thread_pool.h"
+
+#include <cstdint>
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <exception>
+
+namespace _2048 {
+namespace ai {
+
+thread_local const ThreadPool *ThreadPool::current_pool_ = nullptr;
+thread_local uint32_t ThreadPool::current_index_ = 0;
+
+// constructor
+ThreadPool::ThreadPool(uint32_t size) : queued_(0), stop_(false) {
+    if (size == 0)
+        size = std::max(std::thread::hardware_concurrency(), 1u);
+    for (uint32_t i = 0; i < size; i++)
+        deques_.push_back(std::make_unique<Deque>());
+    for (uint32_t i = 1; i < size; i++)
+        threads_.emplace_back(&ThreadPool::Work, this, i);
+}
+
+// destructor
+ThreadPool::~ThreadPool() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread &thread : threads_)
+        thread.join();
+}
+
+// index of the calling thread
+uint32_t ThreadPool::CurrentThread() const noexcept {
+    return current_pool_ == this ? current_index_ : 0;
+}
+
+// run tasks
+void ThreadPool::Run(uint32_t count,
+                     const std::function<void(uint32_t, uint32_t)> &task) {
+    if (count == 0)
+        return;
+    Group group;
+    group.body = &task;
+    group.pending = count;
+    if (current_pool_ == this) {
+        RunGroup(count, &group, current_index_);
+    } else {
+        // join the pool as thread 0
+        std::lock_guard<std::mutex> lock(external_);
+        const ThreadPool *const pool = current_pool_;
+        const uint32_t index = current_index_;
+        current_pool_ = this;
+        current_index_ = 0;
+        RunGroup(count, &group, 0);
+        current_pool_ = pool;
+        current_index_ = index;
+    }
+    if (group.error != nullptr)
+        std::rethrow_exception(group.error);
+}
+
+// push a group and help until it is done
+void ThreadPool::RunGroup(uint32_t count, Group *group, uint32_t index) {
+    {
+        // the owner takes the newest task first, so task 0 goes last
+        Deque &deque = *deques_[index];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        for (uint32_t i = count; i > 0; i--)
+            deque.tasks.push_back(Task{group, i - 1});
+    }
+    queued_ += count;
+    {
+        std::lock_guard<std::mutex> lock(sleep_mutex_);
+    }
+    wake_.notify_all();
+
+    while (group->pending.load(std::memory_order_acquire) > 0)
+        if (!RunOne(index))
+            std::this_thread::yield();
+}
+
+// run one task
+bool ThreadPool::RunOne(uint32_t index) {
+    Task task;
+    bool found = false;
+    {
+        Deque &deque = *deques_[index];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        if (!deque.tasks.empty()) {
+            task = deque.tasks.back();
+            deque.tasks.pop_back();
+            found = true;
+        }
+    }
+    if (!found && !Steal(index, &task))
+        return false;
+    queued_--;
+
+    Group &group = *task.group;
+    try {
+        (*group.body)(index, task.index);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(group.mutex);
+        if (group.error == nullptr)
+            group.error = std::current_exception();
+    }
+    // the group may be destroyed as soon as it has no pending task
+    group.pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+// steal half of the tasks of another thread
+bool ThreadPool::Steal(uint32_t index, Task *task) {
+    const uint32_t size = deques_.size();
+    std::vector<Task> stolen;
+    for (uint32_t k = 1; k < size && stolen.empty(); k++) {
+        Deque &victim = *deques_[(index + k) % size];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        const size_t half = (victim.tasks.size() + 1) / 2;
+        stolen.assign(victim.tasks.begin(), victim.tasks.begin() + half);
+        victim.tasks.erase(victim.tasks.begin(), victim.tasks.begin() + half);
+    }
+    if (stolen.empty())
+        return false;
+
+    // run the newest stolen task, and keep the others in order
+    *task = stolen.back();
+    stolen.pop_back();
+    if (!stolen.empty()) {
+        Deque &deque = *deques_[index];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        deque.tasks.insert(deque.tasks.begin(), stolen.begin(), stolen.end());
+    }
+    return true;
+}
+
+// background thread
+void ThreadPool::Work(uint32_t index) {
+    current_pool_ = this;
+    current_index_ = index;
+    while (!stop_) {
+        if (RunOne(index))
+            continue;
+        std::unique_lock<std::mutex> lock(sleep_mutex_);
+        wake_.wait(lock, [this] { return stop_ || queued_ > 0; });
+    }
+}
+
+}  // namespace ai
+}  // namespace _2048
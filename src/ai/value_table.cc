@@ -0,0 +1,182 @@
+#include "ai/value_table.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "symmetry.h"
+
+namespace _2048 {
+namespace ai {
+
+namespace {
+
+// header of a table file, followed by the keys and then the values
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint8_t height;
+    uint8_t width;
+    uint8_t objective;
+    uint8_t reserved;
+    uint64_t size;
+};
+static_assert(sizeof(Header) == 24, "keys must be aligned");
+
+constexpr char kMagic[8] = {'2', '0', '4', '8', 'T', 'B', 'L', '\0'};
+constexpr uint32_t kVersion = 1;
+
+}  // namespace
+
+// constructor
+TableKeys::TableKeys(uint32_t height, uint32_t width)
+        : height_(height), width_(width) {
+    if (height == 0 || width == 0 || height * width > kMaxTiles)
+        throw std::invalid_argument("board size out of range");
+    // the tile each tile goes to under each symmetry but the identity
+    const uint8_t count = height == width ? Symmetry::kCount : 4;
+    for (uint8_t i = 1; i < count; i++) {
+        const Symmetry s(i);
+        std::vector<uint8_t> map(height * width);
+        bool identity = true;
+        for (uint32_t r = 0; r < height; r++)
+            for (uint32_t c = 0; c < width; c++) {
+                uint32_t to_r = s.transpose() ? c : r;
+                uint32_t to_c = s.transpose() ? r : c;
+                if (s.mirror_rows())
+                    to_r = height - 1 - to_r;
+                if (s.mirror_cols())
+                    to_c = width - 1 - to_c;
+                map[r * width + c] = to_r * width + to_c;
+                identity = identity && map[r * width + c] == r * width + c;
+            }
+        // a board of one row or col is its own reflection along it
+        if (!identity)
+            maps_.push_back(std::move(map));
+    }
+}
+
+// pack
+uint64_t TableKeys::Pack(const GameState &state) const {
+    if (state.height() != height_ || state.width() != width_)
+        throw std::invalid_argument("game state size mismatch");
+    uint64_t key = 0;
+    for (uint32_t r = 0; r < height_; r++)
+        for (uint32_t c = 0; c < width_; c++) {
+            const uint8_t power =
+                    state.tile(GameState::Position(r, c)).power();
+            if (power > kMaxPower)
+                throw std::invalid_argument("tile power too large");
+            key |= static_cast<uint64_t>(power) << 4 * (r * width_ + c);
+        }
+    return key;
+}
+
+// canonical key
+uint64_t TableKeys::Canonical(uint64_t key) const noexcept {
+    uint64_t best = key;
+    for (const std::vector<uint8_t> &map : maps_) {
+        uint64_t copy = 0;
+        for (uint32_t i = 0; i < map.size(); i++)
+            copy |= (key >> 4 * i & 0xF) << 4 * map[i];
+        best = std::min(best, copy);
+    }
+    return best;
+}
+
+// constructor
+ValueTable::ValueTable(const std::string &path)
+        : data_(MAP_FAILED), length_(0) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("cannot open value table " + path);
+    struct stat st;
+    if (fstat(fd, &st) == 0 &&
+            st.st_size >= static_cast<off_t>(sizeof(Header))) {
+        length_ = st.st_size;
+        data_ = mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (data_ == MAP_FAILED)
+        throw std::runtime_error("cannot map value table " + path);
+
+    Header header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+            header.version != kVersion || header.height == 0 ||
+            header.width == 0 ||
+            header.height * header.width > TableKeys::kMaxTiles ||
+            header.objective > static_cast<uint8_t>(Objective::SCORE) ||
+            header.size > (length_ - sizeof(Header)) / 16 ||
+            sizeof(Header) + header.size * 16 != length_) {
+        munmap(data_, length_);
+        throw std::runtime_error("invalid value table " + path);
+    }
+    height_ = header.height;
+    width_ = header.width;
+    objective_ = static_cast<Objective>(header.objective);
+    size_ = header.size;
+    keys_ = reinterpret_cast<const uint64_t *>(
+            static_cast<const char *>(data_) + sizeof(Header));
+    values_ = reinterpret_cast<const double *>(keys_ + size_);
+}
+
+// destructor
+ValueTable::~ValueTable() noexcept {
+    munmap(data_, length_);
+}
+
+// find
+bool ValueTable::Find(uint64_t key, double *value) const noexcept {
+    const uint64_t *it = std::lower_bound(keys_, keys_ + size_, key);
+    if (it == keys_ + size_ || *it != key)
+        return false;
+    if (value != nullptr)
+        *value = values_[it - keys_];
+    return true;
+}
+
+// write
+void ValueTable::Write(const std::string &path, uint32_t height,
+                       uint32_t width, Objective objective,
+                       const std::vector<uint64_t> &keys,
+                       const std::vector<double> &values) {
+    if (height == 0 || width == 0 || height * width > TableKeys::kMaxTiles)
+        throw std::invalid_argument("board size out of range");
+    if (keys.size() != values.size())
+        throw std::invalid_argument("one value for each key needed");
+    if (std::adjacent_find(keys.begin(), keys.end(),
+                           [](uint64_t a, uint64_t b) { return a >= b; }) !=
+            keys.end())
+        throw std::invalid_argument("keys not increasing");
+
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.height = height;
+    header.width = width;
+    header.objective = static_cast<uint8_t>(objective);
+    header.reserved = 0;
+    header.size = keys.size();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(keys.data()),
+              keys.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char *>(values.data()),
+              values.size() * sizeof(double));
+    out.close();
+    if (!out)
+        throw std::runtime_error("cannot write value table " + path);
+}
+
+}  // namespace ai
+}  // namespace _2048
@@ -54,6 +54,7 @@ int main(int argc, char **argv) {
     }
 
     using _2048::Game;
+    using _2048::SearchLimits;
     using _2048::ai::RandomGenerator;
     using _2048::ai::RandomPlayer;
     using _2048::ui::NcursesViewer;
@@ -75,10 +76,13 @@ int main(int argc, char **argv) {
             return 0;
         if (!pause) {
             if (player_turn) {
-                std::this_thread::sleep_for(
-                        std::chrono::milliseconds(cycle * 4 / 5));
-                if (game.Play())
+                // the player may think until its share of the cycle is over
+                const SearchLimits limits =
+                        SearchLimits::Within(std::chrono::milliseconds(
+                                cycle * 4 / 5));
+                if (game.Play(limits))
                     player_turn = false;
+                std::this_thread::sleep_until(limits.deadline);
             } else {
                 std::this_thread::sleep_for(
                         std::chrono::milliseconds(cycle * 1 / 5));
@@ -0,0 +1,44 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <stdexcept>
+
+#include "ai/solver.h"
+
+int main(int argc, char **argv) {
+    using _2048::ai::Solver;
+
+    // parse height, width, objective and path
+    if (argc != 5) {
+        std::cerr << "usage: " << argv[0]
+                  << " <height> <width> <moves|score> <table>" << std::endl;
+        return 1;
+    }
+    uint32_t height, width;
+    try {
+        height = std::stoul(argv[1]);
+        width = std::stoul(argv[2]);
+    } catch (const std::logic_error &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    const std::string objective = argv[3];
+    if (objective != "moves" && objective != "score") {
+        std::cerr << "objective must be moves or score" << std::endl;
+        return 1;
+    }
+
+    try {
+        Solver solver(height, width, objective == "moves" ?
+                                     Solver::Objective::MOVES :
+                                     Solver::Objective::SCORE);
+        solver.Write(argv[4]);
+        std::cout << solver.keys().size() << " positions, "
+                  << solver.start_value() << " expected " << objective
+                  << " per game" << std::endl;
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
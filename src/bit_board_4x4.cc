@@ -0,0 +1,217 @@
+#include "bit_board_4x4.h"
+
+#include <cstdint>
+#include <vector>
+#include <ostream>
+#include <stdexcept>
+
+namespace _2048 {
+
+namespace {
+
+// slide and merge a packed row towards col 0
+// col c of the row is stored in bits [4c, 4c + 4)
+// add the score gained by merging to `*score`
+// add the number of merges to `*merges`
+uint16_t MoveRowLeft(uint16_t row, uint32_t *score, uint8_t *merges) noexcept {
+    uint16_t result = 0;
+    uint32_t n = 0;             // number of tiles in result
+    bool last_merged = true;    // whether the last tile can still merge
+    for (uint32_t c = 0; c < BitBoard4x4::kWidth; c++) {
+        uint8_t power = (row >> (4 * c)) & 0xF;
+        if (power == 0)
+            continue;
+        uint8_t last = n == 0 ? 0 : (result >> (4 * (n - 1))) & 0xF;
+        if (!last_merged && last == power) {
+            if (power < BitBoard4x4::kMaxPower)
+                result += 1 << (4 * (n - 1));
+            *score += 2u << power;
+            ++*merges;
+            last_merged = true;
+        } else {
+            result |= power << (4 * n++);
+            last_merged = false;
+        }
+    }
+    return result;
+}
+
+// slide and merge a packed row towards col 0, without counting
+uint16_t MoveRowLeft(uint16_t row) noexcept {
+    uint32_t score = 0;
+    uint8_t merges = 0;
+    return MoveRowLeft(row, &score, &merges);
+}
+
+// reverse the order of the tiles in a packed row
+constexpr uint16_t ReverseRow(uint16_t row) noexcept {
+    return ((row & 0x000F) << 12) | ((row & 0x00F0) << 4) |
+           ((row & 0x0F00) >> 4)  | ((row & 0xF000) >> 12);
+}
+
+// results of moving every possible packed row
+struct RowTable {
+    uint16_t left[1 << 16];     /**< Row after moving left */
+    uint16_t right[1 << 16];    /**< Row after moving right */
+    uint32_t score[1 << 16];    /**< Score gained in either direction */
+    uint8_t  merges[1 << 16];   /**< Merges in either direction */
+
+    RowTable() noexcept {
+        for (uint32_t row = 0; row < (1 << 16); row++) {
+            score[row] = 0;
+            merges[row] = 0;
+            left[row]  = MoveRowLeft(row, &score[row], &merges[row]);
+            right[row] = ReverseRow(MoveRowLeft(ReverseRow(row)));
+        }
+    }
+};
+
+// built once on first use, so static initializers may also move boards
+const RowTable &GetRowTable() noexcept {
+    static const RowTable table;
+    return table;
+}
+
+// apply a row table to the four rows of a board
+// add the score and merges of the four rows to `*result`
+uint64_t MoveRows(uint64_t board, const RowTable &table, const uint16_t *rows,
+                  GameState::MoveResult *result) noexcept {
+    uint64_t moved = 0;
+    for (uint32_t r = 0; r < BitBoard4x4::kHeight; r++) {
+        uint16_t row = board >> (16 * r);
+        moved |= static_cast<uint64_t>(rows[row]) << (16 * r);
+        result->score  += table.score[row];
+        result->merges += table.merges[row];
+    }
+    return moved;
+}
+
+}  // namespace
+
+// construct from game state
+BitBoard4x4::BitBoard4x4(const GameState &state) : board_(0) {
+    if (state.height() != kHeight || state.width() != kWidth)
+        throw std::invalid_argument("GameState is not 4x4");
+    for (uint32_t r = 0; r < kHeight; r++)
+        for (uint32_t c = 0; c < kWidth; c++) {
+            uint8_t power = state.tile(Position(r, c)).power();
+            if (power > kMaxPower)
+                throw std::invalid_argument("tile too large for BitBoard4x4");
+            board_ |= static_cast<uint64_t>(power) << shift(r, c);
+        }
+}
+
+// convert to game state
+GameState BitBoard4x4::ToGameState() const {
+    GameState state(kHeight, kWidth);
+    for (uint32_t r = 0; r < kHeight; r++)
+        for (uint32_t c = 0; c < kWidth; c++)
+            if (power(r, c) != 0)
+                state.GenerateTile(Position(r, c), power(r, c));
+    return state;
+}
+
+// get tile
+Tile BitBoard4x4::tile(Position pos) const {
+    if (pos.r >= kHeight || pos.c >= kWidth)
+        throw std::out_of_range("row or col index out of range");
+    return Tile(power(pos.r, pos.c));
+}
+
+// get empty tiles
+std::vector<BitBoard4x4::Position> BitBoard4x4::GetEmptyTiles() const {
+    std::vector<Position> empties;
+    for (uint32_t r = 0; r < kHeight; r++)
+        for (uint32_t c = 0; c < kWidth; c++)
+            if (power(r, c) == 0)
+                empties.emplace_back(r, c);
+    return empties;
+}
+
+// get n-th empty tile
+BitBoard4x4::Position BitBoard4x4::GetEmptyTile(uint32_t n) const {
+    uint64_t empties = EmptyNibbles();
+    if (n >= static_cast<uint32_t>(__builtin_popcountll(empties)))
+        throw std::out_of_range("empty tile index out of range");
+    for (; n > 0; n--)
+        empties &= empties - 1;
+    uint32_t i = __builtin_ctzll(empties) / 4;
+    return Position(i / kWidth, i % kWidth);
+}
+
+// generate tile
+bool BitBoard4x4::GenerateTile(Position pos, uint8_t power) {
+    if (tile(pos).power() != 0)
+        return false;
+    if (power > kMaxPower)
+        throw std::invalid_argument("tile too large for BitBoard4x4");
+    board_ |= static_cast<uint64_t>(power) << shift(pos.r, pos.c);
+    return true;
+}
+
+// get possible moves
+std::vector<BitBoard4x4::Direction> BitBoard4x4::GetPossibleMoves() const {
+    DirectionMask mask = GetPossibleMoveMask();
+    std::vector<Direction> directions;
+    for (Direction dir : GameState::kDirections)
+        if (mask & GameState::ToMask(dir))
+            directions.push_back(dir);
+    return directions;
+}
+
+// get possible move mask
+BitBoard4x4::DirectionMask BitBoard4x4::GetPossibleMoveMask() const noexcept {
+    DirectionMask mask = 0;
+    for (Direction dir : GameState::kDirections) {
+        BitBoard4x4 moved(*this);
+        if (moved.Move(dir))
+            mask |= GameState::ToMask(dir);
+    }
+    return mask;
+}
+
+// apply move
+BitBoard4x4::MoveResult BitBoard4x4::Move(Direction dir) noexcept {
+    const RowTable &t = GetRowTable();
+    MoveResult result;
+    uint64_t board = 0;
+    switch (dir) {
+        case Direction::LEFT:
+            board = MoveRows(board_, t, t.left, &result);
+            break;
+        case Direction::RIGHT:
+            board = MoveRows(board_, t, t.right, &result);
+            break;
+        case Direction::UP:
+            board = BitBoard4x4(MoveRows(Transpose().raw(), t, t.left,
+                                         &result)).Transpose().raw();
+            break;
+        case Direction::DOWN:
+            board = BitBoard4x4(MoveRows(Transpose().raw(), t, t.right,
+                                         &result)).Transpose().raw();
+            break;
+    }
+    result.moved = board != board_;
+    board_ = board;
+    return result;
+}
+
+// print
+std::ostream &operator<<(std::ostream &os, const BitBoard4x4 &b) {
+    os << '[';
+    for (uint32_t r = 0; r < BitBoard4x4::kHeight; r++) {
+        if (r != 0)
+            os << ',';
+        os << '[';
+        for (uint32_t c = 0; c < BitBoard4x4::kWidth; c++) {
+            if (c != 0)
+                os << ',';
+            os << b.tile(BitBoard4x4::Position(r, c));
+        }
+        os << ']';
+    }
+    os << ']';
+    return os;
+}
+
+}  // namespace _2048
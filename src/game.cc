@@ -7,6 +7,7 @@ namespace _2048 {
 // reset
 void Game::Reset(const GameState &state) {
     state_.reset(new GameState(state));
+    score_ = 0;
     if (viewer_ != nullptr)
         viewer_->Update(*state_);
 }
@@ -14,6 +15,7 @@ void Game::Reset(const GameState &state) {
 // reset move
 void Game::Reset(GameState &&state) {
     state_.reset(new GameState(std::move(state)));
+    score_ = 0;
     if (viewer_ != nullptr)
         viewer_->Update(*state_);
 }
@@ -21,7 +23,7 @@ void Game::Reset(GameState &&state) {
 bool Game::NoMoreMove() const {
     if (state_ == nullptr)
         throw std::runtime_error("invalid game state");
-    return state_->GetPossibleMoves().empty();
+    return state_->GetPossibleMoveMask() == 0;
 }
 
 // generate
@@ -48,15 +50,23 @@ bool Game::Generate() {
 
 // play
 bool Game::Play() {
+    return Play(SearchLimits());
+}
+
+// play within limits
+bool Game::Play(const SearchLimits &limits) {
     if (state_ == nullptr)
         throw std::runtime_error("invalid game state");
     if (player_ == nullptr)
         return false;
 
     GameState::Direction move;
-    bool success = player_->Play(*state_, &move);
-    if (success)
-        success = state_->Move(move);
+    bool success = player_->Play(*state_, &move, limits);
+    if (success) {
+        GameState::MoveResult result = state_->Move(move);
+        success = result.moved;
+        score_ += result.score;
+    }
     if (success && viewer_ != nullptr)
         viewer_->Update(*state_);
     return success;
@@ -1,25 +1,95 @@
 #include "game_state.h"
 
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
 #include <vector>
+#include <stdexcept>
+
+#include "line.h"
+#include "line_kernel.h"
 
 namespace _2048 {
 
+// construct an empty game state
+GameState::GameState(uint32_t height, uint32_t width)
+        : grid_(height, width),
+          empty_((static_cast<size_t>(height) * width + 63) / 64, ~0ull),
+          num_tiles_(0),
+          max_power_(0),
+          power_sum_(0),
+          hash_(0) {
+    const size_t size = static_cast<size_t>(height) * width;
+    if (size % 64 != 0)
+        empty_.back() = (1ull << (size % 64)) - 1;
+}
+
 // get empty tiles
 std::vector<GameState::Position> GameState::GetEmptyTiles() const {
+    CheckValid();
     std::vector<GameState::Position> empties;
-    for (uint32_t r = 0; r < height(); r++)
-        for (uint32_t c = 0; c < width(); c++)
-            if (tile(Position(r, c)).empty())
-                empties.emplace_back(r, c);
+    empties.reserve(CountEmptyTiles());
+    for (size_t w = 0; w < empty_.size(); w++)
+        for (uint64_t bits = empty_[w]; bits != 0; bits &= bits - 1) {
+            const uint32_t i = w * 64 + __builtin_ctzll(bits);
+            empties.emplace_back(i / width(), i % width());
+        }
     return empties;
 }
 
+// get n-th empty tile
+GameState::Position GameState::GetEmptyTile(uint32_t n) const {
+    CheckValid();
+    for (size_t w = 0; w < empty_.size(); w++) {
+        uint64_t bits = empty_[w];
+        const uint32_t count = __builtin_popcountll(bits);
+        if (n >= count) {
+            n -= count;
+            continue;
+        }
+        for (; n > 0; n--)
+            bits &= bits - 1;
+        const uint32_t i = w * 64 + __builtin_ctzll(bits);
+        return Position(i / width(), i % width());
+    }
+    throw std::out_of_range("empty tile index out of range");
+}
+
 // generate tile
 bool GameState::GenerateTile(GameState::Position pos, uint8_t power) {
     if (!tile(pos).empty())
         return false;
+    if (power == 0)
+        return true;
     grid_.tile(pos.r, pos.c) = Tile(power);
+    const size_t i = static_cast<size_t>(pos.r) * width() + pos.c;
+    empty_[i / 64] &= ~(1ull << (i % 64));
+    num_tiles_++;
+    power_sum_ += power;
+    hash_ ^= ZobristKey(i, power);
+    if (power > max_power_)
+        max_power_ = power;
+    return true;
+}
+
+// generate tile with undo record
+bool GameState::GenerateTile(GameState::Position pos, uint8_t power,
+                             UndoRecord *undo) {
+    undo->kind_ = UndoRecord::Kind::NONE;
+    const uint32_t num_tiles = num_tiles_;
+    const uint8_t max_power = max_power_;
+    const uint64_t power_sum = power_sum_;
+    const uint64_t hash = hash_;
+    if (!GenerateTile(pos, power))
+        return false;
+    undo->kind_ = UndoRecord::Kind::TILE;
+    undo->pos_ = pos;
+    undo->height_ = height();
+    undo->width_ = width();
+    undo->num_tiles_ = num_tiles;
+    undo->max_power_ = max_power;
+    undo->power_sum_ = power_sum;
+    undo->hash_ = hash;
     return true;
 }
 
@@ -88,108 +158,263 @@ void GameState::GetPossibleDir(bool *left, bool *right,
 
 // get possible moves
 std::vector<GameState::Direction> GameState::GetPossibleMoves() const {
-    bool left, right, up, down;
+    DirectionMask mask = GetPossibleMoveMask();
     std::vector<GameState::Direction> directions;
+    for (Direction dir : kDirections)
+        if (mask & ToMask(dir))
+            directions.push_back(dir);
+    return directions;
+}
 
+// get possible move mask
+GameState::DirectionMask GameState::GetPossibleMoveMask() const {
+    bool left, right, up, down;
     GetPossibleDir(&left, &right, &up, &down);
-    if (left)  directions.push_back(GameState::Direction::LEFT);
-    if (right) directions.push_back(GameState::Direction::RIGHT);
-    if (up)    directions.push_back(GameState::Direction::UP);
-    if (down)  directions.push_back(GameState::Direction::DOWN);
-
-    return directions;
+    return (left  ? ToMask(Direction::LEFT)  : 0) |
+           (right ? ToMask(Direction::RIGHT) : 0) |
+           (up    ? ToMask(Direction::UP)    : 0) |
+           (down  ? ToMask(Direction::DOWN)  : 0);
 }
 
-// apply move
-bool GameState::Move(GameState::Direction dir) {
-    // check if move is possible
-    bool possible;
+// get lines along a direction
+GameState::Lines GameState::GetLines(Direction dir) const noexcept {
+    const ptrdiff_t h = height();
+    const ptrdiff_t w = width();
     switch (dir) {
         case Direction::LEFT:
-            GetPossibleDir(&possible, nullptr, nullptr, nullptr);
-            break;
+            return Lines{height(), width(), 0, w, 1};
         case Direction::RIGHT:
-            GetPossibleDir(nullptr, &possible, nullptr, nullptr);
-            break;
+            return Lines{height(), width(), w - 1, w, -1};
         case Direction::UP:
-            GetPossibleDir(nullptr, nullptr, &possible, nullptr);
-            break;
+            return Lines{width(), height(), 0, 1, w};
         case Direction::DOWN:
-            GetPossibleDir(nullptr, nullptr, nullptr, &possible);
-            break;
+        default:
+            return Lines{width(), height(), (h - 1) * w, 1, -w};
     }
-    if (!possible) return false;
+}
 
-    switch (dir) {
-        case Direction::LEFT:
-            for (uint32_t r = 0; r < height(); r++)
-                for (uint32_t c0 = 1, c1 = 0; c0 < width(); c0++) {
-                    if (grid_.tile(r, c0).empty()) {
-                        continue;
-                    } else if (grid_.tile(r, c1).empty()) {
-                        grid_.tile(r, c1) = grid_.tile(r, c0);
-                    } else if (grid_.tile(r, c1) == grid_.tile(r, c0)) {
-                        ++grid_.tile(r, c1++);
-                    } else {
-                        grid_.tile(r, ++c1) = grid_.tile(r, c0);
-                        if (c0 == c1) continue;
-                    }
-                    grid_.tile(r, c0) = Tile::kEmpty;
-                }
-            break;
-        case Direction::RIGHT:
-            for (uint32_t r = 0; r < height(); r++)
-                for (uint32_t c0 = width() - 2, c1 = width() - 1;
-                        c0 < width(); c0--) {
-                    if (grid_.tile(r, c0).empty()) {
-                        continue;
-                    } else if (grid_.tile(r, c1).empty()) {
-                        grid_.tile(r, c1) = grid_.tile(r, c0);
-                    } else if (grid_.tile(r, c1) == grid_.tile(r, c0)) {
-                        ++grid_.tile(r, c1--);
-                    } else {
-                        grid_.tile(r, --c1) = grid_.tile(r, c0);
-                        if (c0 == c1) continue;
-                    }
-                    grid_.tile(r, c0) = Tile::kEmpty;
-                }
-            break;
-        case Direction::UP:
-            for (uint32_t c = 0; c < width(); c++)
-                for (uint32_t r0 = 1, r1 = 0;
-                        r0 < height(); r0++) {
-                    if (grid_.tile(r0, c).empty()) {
-                        continue;
-                    } else if (grid_.tile(r1, c).empty()) {
-                        grid_.tile(r1, c) = grid_.tile(r0, c);
-                    } else if (grid_.tile(r1, c) == grid_.tile(r0, c)) {
-                        ++grid_.tile(r1++, c);
-                    } else {
-                        grid_.tile(++r1, c) = grid_.tile(r0, c);
-                        if (r0 == r1) continue;
-                    }
-                    grid_.tile(r0, c) = Tile::kEmpty;
-                }
-            break;
-        case Direction::DOWN:
-            for (uint32_t c = 0; c < width(); c++)
-                for (uint32_t r0 = height() - 2, r1 = height() - 1;
-                        r0 < height(); r0--) {
-                    if (grid_.tile(r0, c).empty()) {
-                        continue;
-                    } else if (grid_.tile(r1, c).empty()) {
-                        grid_.tile(r1, c) = grid_.tile(r0, c);
-                    } else if (grid_.tile(r1, c) == grid_.tile(r0, c)) {
-                        ++grid_.tile(r1--, c);
-                    } else {
-                        grid_.tile(--r1, c) = grid_.tile(r0, c);
-                        if (r0 == r1) continue;
-                    }
-                    grid_.tile(r0, c) = Tile::kEmpty;
+// apply move
+GameState::MoveResult GameState::Move(GameState::Direction dir) {
+    return Move(dir, nullptr);
+}
+
+namespace {
+
+// shortest line worth moving with the SIMD kernel
+constexpr uint32_t kMinKernelLine = 8;
+
+// number of lines copied out of the grid for the kernel at a time
+constexpr uint32_t kKernelBlock = 8;
+
+inline bool TestBit(const std::vector<uint64_t> &bits, size_t i) noexcept {
+    return (bits[i / 64] >> (i % 64)) & 1;
+}
+
+inline void SetBit(uint64_t *bits, size_t i) noexcept {
+    bits[i / 64] |= 1ull << (i % 64);
+}
+
+}  // namespace
+
+// refresh the empty tile bitmap of a line
+void GameState::UpdateEmptyBitmap(ptrdiff_t first, uint32_t length,
+                                  ptrdiff_t stride) noexcept {
+    const Tile *tiles = grid_.data();
+    for (uint32_t k = 0; k < length; k++) {
+        const size_t i = first + k * stride;
+        const uint64_t bit = 1ull << (i % 64);
+        if (tiles[i].empty())
+            empty_[i / 64] |= bit;
+        else
+            empty_[i / 64] &= ~bit;
+    }
+}
+
+// get the hash of a line
+uint64_t GameState::HashLine(ptrdiff_t first, uint32_t length,
+                             ptrdiff_t stride) const noexcept {
+    const Tile *tiles = grid_.data();
+    uint64_t hash = 0;
+    for (uint32_t k = 0; k < length; k++) {
+        const size_t i = first + k * stride;
+        if (!tiles[i].empty())
+            hash ^= ZobristKey(i, tiles[i].power());
+    }
+    return hash;
+}
+
+// check whether a line can move
+bool GameState::CanMoveLine(ptrdiff_t first, uint32_t length,
+                            ptrdiff_t stride) const noexcept {
+    // a line moves if a tile follows an empty tile, or if it is packed and
+    // two neighbours are equal
+    const Tile *tiles = grid_.data();
+    for (uint32_t k = 0; k + 1 < length; k++) {
+        const Tile &tile = tiles[first + k * stride];
+        const Tile &next = tiles[first + (k + 1) * stride];
+        if (!next.empty() && (tile.empty() || tile == next))
+            return true;
+    }
+    return false;
+}
+
+// apply move with optional undo record
+GameState::MoveResult GameState::Move(GameState::Direction dir,
+                                      UndoRecord *undo) {
+    Tile *tiles = grid_.data();
+    const uint32_t size = height() * width();
+    const Lines lines = GetLines(dir);
+
+    uint64_t *merged = nullptr;
+    if (undo != nullptr) {
+        undo->kind_ = UndoRecord::Kind::MOVE;
+        undo->dir_ = dir;
+        undo->height_ = height();
+        undo->width_ = width();
+        undo->num_tiles_ = num_tiles_;
+        undo->max_power_ = max_power_;
+        undo->power_sum_ = power_sum_;
+        undo->hash_ = hash_;
+        undo->occupied_.assign((size + 63) / 64, 0);
+        undo->merged_.assign((size + 63) / 64, 0);
+        for (size_t w = 0; w < empty_.size(); w++)
+            undo->occupied_[w] = ~empty_[w];
+        if (size % 64 != 0)
+            undo->occupied_.back() &= (1ull << (size % 64)) - 1;
+        merged = undo->merged_.data();
+    }
+
+    // two tiles of power q - 1 became one tile of power q
+    auto on_merge = [this, tiles, merged](ptrdiff_t pos) {
+        const uint8_t q = tiles[pos].power();
+        power_sum_ -= q - 2;
+        if (q > max_power_)
+            max_power_ = q;
+        if (merged != nullptr)
+            SetBit(merged, pos);
+    };
+
+    // long lines go through the SIMD kernel on the tile bytes: lines that
+    // move left in place, and other lines in blocks of them copied out of
+    // the grid, each in a row of the block in the order it moves
+    static_assert(sizeof(Tile) == 1, "a tile is its power byte");
+    static const MovePowersFunc kernel = GetMovePowers(BestLineKernel());
+    const bool use_kernel = BestLineKernel() != LineKernel::SCALAR &&
+                            lines.length >= kMinKernelLine &&
+                            lines.length <= kMaxKernelLine;
+
+    MoveResult result;
+    if (use_kernel) {
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(tiles);
+        const uint32_t n = lines.length;
+        const ptrdiff_t stride = lines.stride;
+        const bool in_place = stride == 1;
+        uint8_t block[kKernelBlock * kMaxKernelLine];
+        for (uint32_t i = 0; i < lines.count; i += kKernelBlock) {
+            const uint32_t count = std::min(kKernelBlock, lines.count - i);
+            const ptrdiff_t block_first = lines.start + i * lines.step;
+            // cols are copied a row of the grid at a time
+            if (!in_place)
+                for (uint32_t k = 0; k < n; k++)
+                    for (uint32_t j = 0; j < count; j++)
+                        block[j * n + k] = bytes[block_first + j * lines.step +
+                                                 k * stride];
+            for (uint32_t j = 0; j < count; j++) {
+                const ptrdiff_t first = block_first + j * lines.step;
+                uint8_t *line = in_place ? bytes + first : block + j * n;
+                uint8_t old[kMaxKernelLine];
+                std::memcpy(old, line, n);
+                uint32_t merged_tiles;
+                if (!kernel(line, n, &result.score, &result.merges,
+                            &merged_tiles))
+                    continue;
+                result.moved = true;
+                // the tiles before the first one that changes keep their
+                // keys, and the keys of the others cancel out if they stay
+                uint32_t k = 0;
+                while (line[k] == old[k])
+                    k++;
+                for (; k < n; k++) {
+                    const size_t pos = first + k * stride;
+                    const uint64_t bit = 1ull << (pos % 64);
+                    hash_ ^= (old[k] != 0 ? ZobristKey(pos, old[k]) : 0) ^
+                             (line[k] != 0 ? ZobristKey(pos, line[k]) : 0);
+                    empty_[pos / 64] = (empty_[pos / 64] & ~bit) |
+                                       (line[k] == 0 ? bit : 0);
+                    if (!in_place)
+                        tiles[pos] = Tile(line[k]);
                 }
-            break;
+                for (; merged_tiles != 0; merged_tiles &= merged_tiles - 1)
+                    on_merge(first + __builtin_ctz(merged_tiles) * stride);
+            }
+        }
+        num_tiles_ -= result.merges;
+        return result;
+    }
+
+    for (uint32_t i = 0; i < lines.count; i++) {
+        const ptrdiff_t first = lines.start + i * lines.step;
+        const ptrdiff_t stride = lines.stride;
+        // only the lines that move are hashed, before and after the move
+        if (!CanMoveLine(first, lines.length, stride))
+            continue;
+        hash_ ^= HashLine(first, lines.length, stride);
+        MoveLine(tiles + first, lines.length, stride, &result.score,
+                 &result.merges, [on_merge, first, stride](uint32_t k) {
+                     on_merge(first + k * stride);
+                 });
+        UpdateEmptyBitmap(first, lines.length, stride);
+        hash_ ^= HashLine(first, lines.length, stride);
+        result.moved = true;
+    }
+    num_tiles_ -= result.merges;
+    return result;
+}
+
+// undo
+void GameState::Undo(const UndoRecord &undo) {
+    Tile *tiles = grid_.data();
+    if (undo.kind_ == UndoRecord::Kind::NONE)
+        return;
+    if (undo.height_ != height() || undo.width_ != width())
+        throw std::logic_error("undo record size mismatch");
+    num_tiles_ = undo.num_tiles_;
+    max_power_ = undo.max_power_;
+    power_sum_ = undo.power_sum_;
+    hash_ = undo.hash_;
+    if (undo.kind_ == UndoRecord::Kind::TILE) {
+        grid_.tile(undo.pos_.r, undo.pos_.c) = Tile::kEmpty;
+        const size_t i =
+                static_cast<size_t>(undo.pos_.r) * width() + undo.pos_.c;
+        empty_[i / 64] |= 1ull << (i % 64);
+        return;
+    }
+
+    // after a move, the tiles of every line are packed at its beginning
+    // put them back to the originally occupied tiles, starting from the end
+    const Lines lines = GetLines(undo.dir_);
+    for (uint32_t i = 0; i < lines.count; i++) {
+        const ptrdiff_t first = lines.start + i * lines.step;
+        const ptrdiff_t stride = lines.stride;
+        uint32_t packed = 0;
+        for (uint32_t k = 0; k < lines.length; k++)
+            packed += !tiles[first + k * stride].empty();
+        uint32_t src = lines.length;
+        for (uint32_t k = packed; k-- > 0; ) {
+            const ptrdiff_t dst = first + k * stride;
+            const Tile tile = tiles[dst];
+            const bool merged = TestBit(undo.merged_, dst);
+            tiles[dst] = Tile::kEmpty;
+            for (uint32_t j = merged ? 2 : 1; j > 0; j--) {
+                do {
+                    src--;
+                } while (!TestBit(undo.occupied_, first + src * stride));
+                tiles[first + src * stride] =
+                        merged ? Tile(tile.power() - 1) : tile;
+            }
+        }
+        UpdateEmptyBitmap(first, lines.length, stride);
     }
-    return true;
 }
 
 }  // namespace _2048
@@ -22,6 +22,19 @@ Grid::Grid(const Grid &g) : Grid(g.height, g.width) {
         grid_[i] = g.grid_[i];
 }
 
+// copy assignment
+Grid &Grid::operator=(const Grid &g) {
+    if (g.grid_ == nullptr)
+        throw std::runtime_error("invalid grid state");
+    if (height != g.height || width != g.width)
+        throw std::invalid_argument("grid size mismatch");
+    if (grid_ == nullptr)
+        grid_.reset(new Tile[height * width]);
+    for (uint32_t i = 0; i < height * width; i++)
+        grid_[i] = g.grid_[i];
+    return *this;
+}
+
 // equality
 bool Grid::operator==(const Grid &g) const {
     if (grid_ == nullptr || g.grid_ == nullptr)
@@ -52,6 +65,20 @@ Tile &Grid::tile(uint32_t r, uint32_t c) {
     return grid_[offset(r, c)];
 }
 
+// const raw accessor
+const Tile *Grid::data() const {
+    if (grid_ == nullptr)
+        throw std::runtime_error("invalid grid state");
+    return grid_.get();
+}
+
+// raw accessor
+Tile *Grid::data() {
+    if (grid_ == nullptr)
+        throw std::runtime_error("invalid grid state");
+    return grid_.get();
+}
+
 // print
 std::ostream &operator<<(std::ostream &os, const Grid &g) {
     if (g.grid_ == nullptr)
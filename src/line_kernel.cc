@@ -0,0 +1,240 @@
+#include "line_kernel.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include "tile.h"
+#include "line.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define LINE_KERNEL_X86
+#endif
+
+namespace _2048 {
+
+namespace {
+
+// size of the scratch buffers, with room to read and write past the line
+constexpr uint32_t kBufferSize = kMaxKernelLine + 16;
+
+// mask of the lowest n bits
+inline uint32_t LowBits(uint32_t n) noexcept {
+    return n >= 32 ? ~0u : (1u << n) - 1;
+}
+
+// scalar kernel
+bool MovePowersScalar(uint8_t *line, uint32_t n, uint64_t *score,
+                      uint32_t *merges, uint32_t *merged) noexcept {
+    Tile tiles[kMaxKernelLine];
+    for (uint32_t i = 0; i < n; i++)
+        tiles[i] = Tile(line[i]);
+    uint32_t mask = 0;
+    const bool changed = MoveLine(tiles, n, 1, score, merges,
+                                  [&mask](uint32_t k) { mask |= 1u << k; });
+    for (uint32_t i = 0; i < n; i++)
+        line[i] = tiles[i].power();
+    *merged = mask;
+    return changed;
+}
+
+#ifdef LINE_KERNEL_X86
+
+// all zero bytes to compare with
+alignas(32) constexpr uint8_t kZeros[kBufferSize] = {};
+
+// pshufb patterns that move the selected bytes of 8 to the front, and zero
+// the rest
+struct CompactTable {
+    uint64_t shuffle[256];
+
+    CompactTable() noexcept {
+        for (uint32_t m = 0; m < 256; m++) {
+            uint64_t pattern = ~0ull;
+            uint32_t k = 0;
+            for (uint32_t i = 0; i < 8; i++)
+                if (m >> i & 1) {
+                    pattern &= ~(0xFFull << 8 * k);
+                    pattern |= static_cast<uint64_t>(i) << 8 * k;
+                    k++;
+                }
+            shuffle[m] = pattern;
+        }
+    }
+};
+
+// get the compaction table, which is built on first use
+const CompactTable &GetCompactTable() noexcept {
+    static const CompactTable table;
+    return table;
+}
+
+// pick the merging pairs of a compacted line from its first tile
+// bit i of `pairs` is set if tile i equals tile i + 1
+inline uint32_t SelectPairs(uint32_t pairs) noexcept {
+    uint32_t selected = 0;
+    while (pairs != 0) {
+        const uint32_t bit = pairs & -pairs;
+        selected |= bit;
+        pairs &= ~(bit | bit << 1);
+    }
+    return selected;
+}
+
+// merge the selected pairs of a compacted line of `count` tiles in place
+// return the mask of the tiles left, and set the indices of the merged tiles
+// after compaction in `*merged`
+inline uint32_t ApplyMerges(uint8_t *line, uint32_t count, uint32_t selected,
+                            uint64_t *score, uint32_t *merges,
+                            uint32_t *merged) noexcept {
+    uint32_t before = 0;
+    for (uint32_t s = selected; s != 0; s &= s - 1) {
+        const uint32_t i = __builtin_ctz(s);
+        *score += 2ull << line[i];
+        line[i]++;
+        line[i + 1] = 0;
+        *merged |= 1u << (i - before);
+        before++;
+    }
+    *merges += before;
+    return LowBits(count) & ~(selected << 1);
+}
+
+// move the bytes of `src` selected by `live` to the front of `dst`
+// return the number of bytes moved
+__attribute__((target("sse4.1"), always_inline))
+inline uint32_t Compact(const uint8_t *src, uint32_t live,
+                        uint8_t *dst) noexcept {
+    const CompactTable &table = GetCompactTable();
+    const __m128i zero = _mm_setzero_si128();
+    for (uint32_t i = 0; i < kBufferSize; i += 16)
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), zero);
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < kMaxKernelLine; i += 8) {
+        const uint32_t m = live >> i & 0xFF;
+        const __m128i bytes =
+                _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i pattern =
+                _mm_cvtsi64_si128(static_cast<int64_t>(table.shuffle[m]));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + count),
+                         _mm_shuffle_epi8(bytes, pattern));
+        count += __builtin_popcount(m);
+    }
+    return count;
+}
+
+// bit i is set if a[i] == b[i], for 32 bytes
+__attribute__((target("sse4.1"), always_inline))
+inline uint32_t EqualMaskSse4(const uint8_t *a, const uint8_t *b) noexcept {
+    const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
+    const __m128i a1 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + 16));
+    const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
+    const __m128i b1 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + 16));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a0, b0))) |
+           static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(a1, b1)))
+                   << 16;
+}
+
+// bit i is set if a[i] == b[i], for 32 bytes
+__attribute__((target("avx2"), always_inline))
+inline uint32_t EqualMaskAvx2(const uint8_t *a, const uint8_t *b) noexcept {
+    const __m256i va =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
+    const __m256i vb =
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
+    return _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+}
+
+// the two kernels below only differ in how they compare bytes
+// the target attributes keep them from sharing a template
+
+// SSE4 kernel
+__attribute__((target("sse4.1")))
+bool MovePowersSse4(uint8_t *line, uint32_t n, uint64_t *score,
+                    uint32_t *merges, uint32_t *merged) noexcept {
+    alignas(16) uint8_t in[kBufferSize] = {};
+    alignas(16) uint8_t packed[kBufferSize];
+    alignas(16) uint8_t out[kBufferSize];
+    std::memcpy(in, line, n);
+
+    const uint32_t live = ~EqualMaskSse4(in, kZeros) & LowBits(n);
+    const uint32_t count = Compact(in, live, packed);
+    const uint32_t pairs = EqualMaskSse4(packed, packed + 1) & LowBits(count);
+    const uint8_t *result = packed;
+    *merged = 0;
+    if (pairs != 0) {
+        const uint32_t selected = SelectPairs(pairs);
+        Compact(packed, ApplyMerges(packed, count, selected, score, merges,
+                                    merged), out);
+        result = out;
+    }
+
+    const bool changed =
+            (EqualMaskSse4(result, in) & LowBits(n)) != LowBits(n);
+    std::memcpy(line, result, n);
+    return changed;
+}
+
+// AVX2 kernel
+__attribute__((target("avx2")))
+bool MovePowersAvx2(uint8_t *line, uint32_t n, uint64_t *score,
+                    uint32_t *merges, uint32_t *merged) noexcept {
+    alignas(32) uint8_t in[kBufferSize] = {};
+    alignas(32) uint8_t packed[kBufferSize];
+    alignas(32) uint8_t out[kBufferSize];
+    std::memcpy(in, line, n);
+
+    const uint32_t live = ~EqualMaskAvx2(in, kZeros) & LowBits(n);
+    const uint32_t count = Compact(in, live, packed);
+    const uint32_t pairs = EqualMaskAvx2(packed, packed + 1) & LowBits(count);
+    const uint8_t *result = packed;
+    *merged = 0;
+    if (pairs != 0) {
+        const uint32_t selected = SelectPairs(pairs);
+        Compact(packed, ApplyMerges(packed, count, selected, score, merges,
+                                    merged), out);
+        result = out;
+    }
+
+    const bool changed =
+            (EqualMaskAvx2(result, in) & LowBits(n)) != LowBits(n);
+    std::memcpy(line, result, n);
+    return changed;
+}
+
+#endif  // LINE_KERNEL_X86
+
+}  // namespace
+
+// detect the best kernel
+LineKernel BestLineKernel() noexcept {
+    static const LineKernel kernel = [] {
+#ifdef LINE_KERNEL_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            return LineKernel::AVX2;
+        if (__builtin_cpu_supports("sse4.1"))
+            return LineKernel::SSE4;
+#endif
+        return LineKernel::SCALAR;
+    }();
+    return kernel;
+}
+
+// get kernel function
+MovePowersFunc GetMovePowers(LineKernel kernel) noexcept {
+    switch (kernel) {
+#ifdef LINE_KERNEL_X86
+        case LineKernel::AVX2:
+            return MovePowersAvx2;
+        case LineKernel::SSE4:
+            return MovePowersSse4;
+#endif
+        default:
+            return MovePowersScalar;
+    }
+}
+
+}  // namespace _2048
@@ -0,0 +1,72 @@
+#include "symmetry.h"
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace _2048 {
+
+namespace {
+
+// throw if the game state is not square
+void CheckSquare(const GameState &state) {
+    if (state.height() != state.width())
+        throw std::invalid_argument("symmetry of a non-square GameState");
+}
+
+}  // namespace
+
+// transform game state
+GameState Transform(const GameState &state, Symmetry s) {
+    CheckSquare(state);
+    const uint32_t n = state.height();
+    GameState result(n, n);
+    for (uint32_t r = 0; r < n; r++)
+        for (uint32_t c = 0; c < n; c++) {
+            const GameState::Position pos(r, c);
+            result.GenerateTile(s.Apply(pos, n), state.tile(pos).power());
+        }
+    return result;
+}
+
+// canonicalize packed board
+Canonical<BitBoard4x4> Canonicalize(BitBoard4x4 board) noexcept {
+    const BitBoard4x4 copies[2] = {board, board.Transpose()};
+    Canonical<BitBoard4x4> best{board, Symmetry()};
+    for (uint8_t t = 0; t < 2; t++) {
+        const BitBoard4x4 rows[2] = {copies[t], copies[t].MirrorRows()};
+        for (uint8_t m = 0; m < 2; m++) {
+            const BitBoard4x4 cols[2] = {rows[m], rows[m].MirrorCols()};
+            for (uint8_t k = 0; k < 2; k++)
+                if (cols[k].raw() < best.board.raw())
+                    best = {cols[k], Symmetry(t << 2 | m << 1 | k)};
+        }
+    }
+    return best;
+}
+
+// canonicalize game state
+Canonical<GameState> Canonicalize(const GameState &state) {
+    CheckSquare(state);
+    const uint32_t n = state.height();
+
+    // compare the copies tile by tile from the last tile, reading the original
+    // grid through the inverse symmetries, and only build the winner
+    Symmetry best;
+    for (uint8_t i = 1; i < Symmetry::kCount; i++) {
+        const Symmetry candidate = Symmetry(i).Inverse();
+        const Symmetry current = best.Inverse();
+        for (uint32_t k = n * n; k-- > 0; ) {
+            const GameState::Position pos(k / n, k % n);
+            const uint8_t a = state.tile(candidate.Apply(pos, n)).power();
+            const uint8_t b = state.tile(current.Apply(pos, n)).power();
+            if (a != b) {
+                if (a < b)
+                    best = Symmetry(i);
+                break;
+            }
+        }
+    }
+    return Canonical<GameState>{Transform(state, best), best};
+}
+
+}  // namespace _2048
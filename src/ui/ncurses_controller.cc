@@ -21,12 +21,14 @@ namespace {
 std::u32string BuildStatus(const GameState &state) {
     std::basic_ostringstream<char32_t> oss;
     // Direction
-    const auto moves = state.GetPossibleMoves();
-    if (moves.empty()) {
+    const GameState::DirectionMask moves = state.GetPossibleMoveMask();
+    if (moves == 0) {
         oss << U"No possible move";
     } else {
         oss << U"Directions: ";
-        for (const auto &dir : state.GetPossibleMoves()) {
+        for (const auto &dir : GameState::kDirections) {
+            if (!(moves & GameState::ToMask(dir)))
+                continue;
             switch (dir) {
                 case GameState::Direction::LEFT:
                     oss << static_cast<char32_t>(ACS_LARROW) << U' '; break;
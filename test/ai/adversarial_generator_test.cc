@@ -0,0 +1,142 @@
+#include "ai/adversarial_generator.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <set>
+#include <stdexcept>
+
+#include "game_state.h"
+#include "ai/eval/eval_func.h"
+#include "ai/eval/sum_exponents.h"
+#include "ai/eval/weight_table/gradient_exponential_4x4.h"
+#include "ai/expectimax_player.h"
+
+namespace {
+
+using _2048::GameState;
+using _2048::ai::AdversarialGenerator;
+using _2048::ai::eval::EvaluationFunction;
+using std::chrono::milliseconds;
+
+// play games of a player with `eval` against the adversary, or against
+// random tiles if it is null, starting from 2 random tiles
+// return the sum of the largest powers reached
+uint32_t PlayGames(const EvaluationFunction &eval,
+                   AdversarialGenerator *adversary, uint32_t height,
+                   uint32_t width, uint32_t games) {
+    _2048::ai::ExpectimaxPlayer player(&eval, 1);
+    std::mt19937_64 engine(games);
+    uint32_t sum = 0;
+    for (uint32_t game = 0; game < games; game++) {
+        GameState state(height, width);
+        for (uint32_t i = 0; i < 2; i++)
+            state.GenerateTile(
+                    state.GetEmptyTile(engine() % state.CountEmptyTiles()), 1);
+        GameState::Direction move;
+        while (player.Play(state, &move)) {
+            state.Move(move);
+            GameState::Position pos =
+                    state.GetEmptyTile(engine() % state.CountEmptyTiles());
+            uint8_t power = engine() % 10 == 0 ? 2 : 1;
+            if (adversary != nullptr) {
+                EXPECT_TRUE(adversary->Generate(state, &pos, &power));
+            }
+            EXPECT_TRUE(state.GenerateTile(pos, power));
+        }
+        sum += state.GetMaxPower();
+    }
+    return sum;
+}
+
+class AdversarialGeneratorTest : public testing::Test {
+ protected:
+    _2048::ai::eval::weight_table::GradientExponential4x4 gradient_;
+};
+
+TEST_F(AdversarialGeneratorTest, Construct) {
+    EXPECT_THROW(AdversarialGenerator(nullptr), std::invalid_argument);
+    EXPECT_THROW(AdversarialGenerator(&gradient_, 0), std::invalid_argument);
+    EXPECT_THROW(AdversarialGenerator(&gradient_, 256), std::invalid_argument);
+}
+
+TEST_F(AdversarialGeneratorTest, FullBoard) {
+    AdversarialGenerator generator(&gradient_);
+    GameState state(2, 2);
+    for (uint32_t i = 0; i < 4; i++)
+        state.GenerateTile(GameState::Position(i / 2, i % 2), i + 1);
+    GameState::Position pos(1, 1);
+    uint8_t power = 5;
+    EXPECT_FALSE(generator.Generate(state, &pos, &power));
+    EXPECT_EQ(pos, GameState::Position(1, 1));
+    EXPECT_EQ(power, 5);
+}
+
+TEST_F(AdversarialGeneratorTest, EndGame) {
+    // a 2 in the corner ends the game, and a 4 would merge
+    // [[2, 4, 2, 4],
+    //  [4, 2, 4, 2],
+    //  [2, 4, 2, 4],
+    //  [4, 2, 8, _]]
+    GameState state(4, 4);
+    for (uint32_t i = 0; i < 15; i++)
+        state.GenerateTile(GameState::Position(i / 4, i % 4),
+                           i == 14 ? 3 : (i / 4 + i % 4) % 2 + 1);
+    for (uint32_t depth : {1, 2, 5}) {
+        AdversarialGenerator generator(&gradient_, depth);
+        GameState::Position pos;
+        uint8_t power;
+        ASSERT_TRUE(generator.Generate(state, &pos, &power));
+        EXPECT_EQ(pos, GameState::Position(3, 3));
+        EXPECT_EQ(power, 1);
+        EXPECT_EQ(generator.value(), EvaluationFunction::kOver);
+    }
+}
+
+TEST_F(AdversarialGeneratorTest, Ties) {
+    // the corners of an empty board are equally bad, and the seed picks one
+    std::set<uint32_t> tiles;
+    for (uint64_t seed = 0; seed < 20; seed++) {
+        AdversarialGenerator generator(&gradient_, 1,
+                                       milliseconds(0), seed);
+        GameState state(4, 4);
+        state.GenerateTile(GameState::Position(1, 1), 1);
+        state.GenerateTile(GameState::Position(2, 2), 1);
+        GameState::Position pos;
+        uint8_t power;
+        ASSERT_TRUE(generator.Generate(state, &pos, &power));
+        tiles.insert(pos.r * 4 + pos.c);
+    }
+    EXPECT_GT(tiles.size(), 1u);
+}
+
+TEST_F(AdversarialGeneratorTest, TimeLimit) {
+    AdversarialGenerator generator(&gradient_, 100, milliseconds(20));
+    GameState state(4, 4);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    GameState::Position pos;
+    uint8_t power;
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(generator.Generate(state, &pos, &power));
+    EXPECT_LT(std::chrono::steady_clock::now() - start,
+              std::chrono::seconds(2));
+    EXPECT_GE(generator.depth(), 1u);
+    EXPECT_LT(generator.depth(), 100u);
+    EXPECT_GT(generator.nodes(), 0u);
+}
+
+TEST_F(AdversarialGeneratorTest, Stress) {
+    // the same player does worse against the adversary than against chance
+    AdversarialGenerator adversary(&gradient_);
+    EXPECT_LT(PlayGames(gradient_, &adversary, 4, 4, 20),
+              PlayGames(gradient_, nullptr, 4, 4, 20));
+
+    // other sizes are searched on `GameState`
+    _2048::ai::eval::SumExponents sum_exponents;
+    AdversarialGenerator small(&sum_exponents);
+    EXPECT_LT(PlayGames(sum_exponents, &small, 3, 3, 5),
+              PlayGames(sum_exponents, nullptr, 3, 3, 5));
+}
+
+}  // namespace
@@ -0,0 +1,62 @@
+#include "ai/arena.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using _2048::ai::Arena;
+
+struct Item {
+    uint64_t a;
+    uint64_t b;
+};
+
+TEST(ArenaTest, Capacity) {
+    EXPECT_EQ(Arena<Item>(0).capacity(), 1u);
+    EXPECT_EQ(Arena<Item>(1).capacity(), 1024u * 1024 / sizeof(Item));
+}
+
+TEST(ArenaTest, Allocate) {
+    Arena<Item> arena(0);
+    EXPECT_EQ(arena.size(), 0u);
+    ASSERT_EQ(arena.Allocate(), 0u);
+    arena[0] = Item{1, 2};
+    EXPECT_EQ(arena[0].b, 2u);
+    EXPECT_EQ(arena.size(), 1u);
+    // a full arena stays full
+    EXPECT_EQ(arena.Allocate(), Arena<Item>::kNone);
+    EXPECT_EQ(arena.Allocate(), Arena<Item>::kNone);
+    EXPECT_EQ(arena.size(), 1u);
+
+    arena.Reset();
+    EXPECT_EQ(arena.size(), 0u);
+    EXPECT_EQ(arena.Allocate(), 0u);
+}
+
+TEST(ArenaTest, Threads) {
+    // every object goes to exactly one thread
+    Arena<Item> arena(1);
+    std::vector<std::vector<uint32_t>> allocated(4);
+    std::vector<std::thread> threads;
+    for (uint32_t t = 0; t < 4; t++)
+        threads.emplace_back([&, t] {
+            for (uint32_t index = arena.Allocate(); index != arena.kNone;
+                    index = arena.Allocate())
+                allocated[t].push_back(index);
+        });
+    for (std::thread &thread : threads)
+        thread.join();
+    std::vector<uint32_t> all;
+    for (const auto &indices : allocated)
+        all.insert(all.end(), indices.begin(), indices.end());
+    std::sort(all.begin(), all.end());
+    ASSERT_EQ(all.size(), arena.capacity());
+    for (uint32_t i = 0; i < all.size(); i++)
+        EXPECT_EQ(all[i], i);
+}
+
+}  // namespace
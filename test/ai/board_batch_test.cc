@@ -0,0 +1,84 @@
+#include "ai/board_batch.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "game_state.h"
+#include "bit_board_4x4.h"
+#include "ai/eval/eval_func.h"
+#include "ai/eval/num_tile.h"
+#include "ai/thread_pool.h"
+
+namespace {
+
+using _2048::BitBoard4x4;
+using _2048::GameState;
+using _2048::ai::BoardBatch;
+
+class BoardBatchTest : public testing::Test {
+ protected:
+    BitBoard4x4 board_;
+
+    void SetUp() override {
+        // [[_,    2,  _,  4],
+        //  [_,    2,  _,  _],
+        //  [8,    4,  4,  _],
+        //  [2048, 64, 32, _]]
+        board_.GenerateTile(GameState::Position(0, 1), 1);
+        board_.GenerateTile(GameState::Position(0, 3), 2);
+        board_.GenerateTile(GameState::Position(1, 1), 1);
+        board_.GenerateTile(GameState::Position(2, 0), 3);
+        board_.GenerateTile(GameState::Position(2, 1), 2);
+        board_.GenerateTile(GameState::Position(2, 2), 2);
+        board_.GenerateTile(GameState::Position(3, 0), 11);
+        board_.GenerateTile(GameState::Position(3, 1), 6);
+        board_.GenerateTile(GameState::Position(3, 2), 5);
+    }
+};
+
+TEST_F(BoardBatchTest, Construct) {
+    BoardBatch empty(3);
+    EXPECT_EQ(empty.size(), 3u);
+    EXPECT_EQ(empty.board(2), BitBoard4x4());
+    BoardBatch batch(2, board_);
+    EXPECT_EQ(batch.board(1), board_);
+    batch.SetBoard(1, BitBoard4x4());
+    EXPECT_EQ(batch.board(0), board_);
+    EXPECT_EQ(batch.board(1), BitBoard4x4());
+}
+
+TEST_F(BoardBatchTest, Evaluate) {
+    BoardBatch batch(2, board_);
+    batch.SetBoard(1, BitBoard4x4());
+    _2048::ai::eval::NumTile eval;
+    const _2048::ai::eval::EvaluationFunction &base = eval;
+    int64_t values[2], base_values[2];
+    batch.Evaluate(eval, values);
+    batch.Evaluate(base, base_values);
+    EXPECT_EQ(values[0], -9);
+    EXPECT_EQ(values[1], 0);
+    EXPECT_EQ(base_values[0], values[0]);
+    EXPECT_EQ(base_values[1], values[1]);
+}
+
+TEST_F(BoardBatchTest, ThreadPool) {
+    // a batch of several chunks gives the same values on a pool
+    const size_t kGames = 3 * BoardBatch::kChunk + 5;
+    _2048::ai::ThreadPool pool(3);
+    std::mt19937_64 engine(13);
+    BoardBatch batch(kGames);
+    for (size_t i = 0; i < kGames; i++)
+        batch.SetBoard(i, BitBoard4x4(engine()));
+
+    _2048::ai::eval::NumTile eval;
+    std::vector<int64_t> values(kGames), pooled_values(kGames);
+    batch.Evaluate(eval, values.data());
+    batch.Evaluate(eval, pooled_values.data(), &pool);
+    EXPECT_EQ(pooled_values, values);
+    for (size_t i = 0; i < kGames; i++)
+        ASSERT_EQ(values[i], eval(batch.board(i)));
+}
+
+}  // namespace
@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 
 #include "game_state.h"
+#include "bit_board_4x4.h"
 
 namespace {
 
@@ -41,4 +42,18 @@ TEST_F(NumTileTest, Normal) {
     EXPECT_EQ(eval_(*state_normal_), -9);
 }
 
+TEST_F(NumTileTest, BitBoard) {
+    EXPECT_EQ(eval_(_2048::BitBoard4x4(*state_empty_)), 0);
+    EXPECT_EQ(eval_(_2048::BitBoard4x4(*state_normal_)), -9);
+}
+
+TEST_F(NumTileTest, Range) {
+    auto range = eval_.GetRange(4, 4, 11);
+    EXPECT_EQ(range.lower, -16);
+    EXPECT_EQ(range.upper, 0);
+    range = eval_.GetRange(3, 5, 1);
+    EXPECT_EQ(range.lower, -15);
+    EXPECT_EQ(range.upper, 0);
+}
+
 }  // namespace
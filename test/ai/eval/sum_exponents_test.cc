@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 
 #include "game_state.h"
+#include "bit_board_4x4.h"
 
 namespace {
 
@@ -42,4 +43,15 @@ TEST_F(SumExponentsTest, Normal) {
     EXPECT_EQ(eval_(*state_normal_), -33);
 }
 
+TEST_F(SumExponentsTest, BitBoard) {
+    EXPECT_EQ(eval_(_2048::BitBoard4x4(*state_empty_)), 0);
+    EXPECT_EQ(eval_(_2048::BitBoard4x4(*state_normal_)), -33);
+}
+
+TEST_F(SumExponentsTest, Range) {
+    auto range = eval_.GetRange(4, 4, 11);
+    EXPECT_EQ(range.lower, -16 * 11);
+    EXPECT_EQ(range.upper, 0);
+}
+
 }  // namespace
@@ -1,8 +1,10 @@
 #include "ai/eval/weight_table/gradient_exponential_4x4.h"
 
 #include <gtest/gtest.h>
+#include <stdexcept>
 
 #include "game_state.h"
+#include "bit_board_4x4.h"
 
 namespace {
 
@@ -42,4 +44,18 @@ TEST_F(GradientExponential4x4Test, Normal) {
     EXPECT_EQ(eval_(*state_normal_), -2672);
 }
 
+TEST_F(GradientExponential4x4Test, BitBoard) {
+    EXPECT_EQ(eval_(_2048::BitBoard4x4(*state_empty_)), 0);
+    EXPECT_EQ(eval_(_2048::BitBoard4x4(*state_normal_)), -2672);
+}
+
+TEST_F(GradientExponential4x4Test, Range) {
+    // the weights add up to -225
+    auto range = eval_.GetRange(4, 4, 11);
+    EXPECT_EQ(range.lower, -225 * 2048);
+    EXPECT_EQ(range.upper, 0);
+    EXPECT_GE(eval_(*state_normal_), range.lower);
+    EXPECT_THROW(eval_.GetRange(5, 5, 11), std::invalid_argument);
+}
+
 }  // namespace
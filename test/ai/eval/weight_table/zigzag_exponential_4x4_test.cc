@@ -3,6 +3,7 @@
 #include <gtest/gtest.h>
 
 #include "game_state.h"
+#include "bit_board_4x4.h"
 
 namespace {
 
@@ -42,4 +43,9 @@ TEST_F(ZigzagExponential4x4Test, Normal) {
     EXPECT_EQ(eval_(*state_normal_), -53888);
 }
 
+TEST_F(ZigzagExponential4x4Test, BitBoard) {
+    EXPECT_EQ(eval_(_2048::BitBoard4x4(*state_empty_)), 0);
+    EXPECT_EQ(eval_(_2048::BitBoard4x4(*state_normal_)), -53888);
+}
+
 }  // namespace
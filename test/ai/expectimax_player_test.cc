@@ -0,0 +1,328 @@
+#include "ai/expectimax_player.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "game_state.h"
+#include "ai/eval/eval_func.h"
+#include "ai/eval/num_tile.h"
+#include "ai/eval/sum_exponents.h"
+#include "ai/eval/weight_table/gradient_exponential_4x4.h"
+#include "ai/thread_pool.h"
+#include "play_game.h"
+
+namespace {
+
+using _2048::GameState;
+using _2048::ai::ExpectimaxPlayer;
+using _2048::ai::ThreadPool;
+using _2048::ai::eval::EvaluationFunction;
+
+// play a game against random spawns, checking every move
+// return the largest power reached
+uint8_t PlayGame(ExpectimaxPlayer *player, GameState state, uint64_t seed,
+                 uint32_t turns) {
+    return _2048::ai::test::PlayGame(player, state, seed, turns, [player] {
+        return player->nodes();
+    });
+}
+
+class ExpectimaxPlayerTest : public testing::Test {
+ protected:
+    _2048::ai::eval::NumTile num_tile_;
+    _2048::ai::eval::weight_table::GradientExponential4x4 gradient_;
+};
+
+TEST_F(ExpectimaxPlayerTest, Construct) {
+    EXPECT_THROW(ExpectimaxPlayer(nullptr, 2), std::invalid_argument);
+    EXPECT_THROW(ExpectimaxPlayer(&num_tile_, 0), std::invalid_argument);
+    EXPECT_EQ(ExpectimaxPlayer(&num_tile_, 3).depth(), 3u);
+}
+
+TEST_F(ExpectimaxPlayerTest, NoMove) {
+    // [[2, 4],
+    //  [8, 16]]
+    GameState state(2, 2);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(0, 1), 2);
+    state.GenerateTile(GameState::Position(1, 0), 3);
+    state.GenerateTile(GameState::Position(1, 1), 4);
+    ExpectimaxPlayer player(&num_tile_, 2);
+    GameState::Direction move = GameState::Direction::LEFT;
+    EXPECT_FALSE(player.Play(state, &move));
+    EXPECT_EQ(move, GameState::Direction::LEFT);
+}
+
+TEST_F(ExpectimaxPlayerTest, PreferMerge) {
+    // [[2, _, _, _],
+    //  [2, _, _, _],
+    //  [4, _, _, _],
+    //  [8, _, _, _]]
+    // only UP and DOWN merge, and ties go to the first direction in
+    // `GameState::kDirections`
+    GameState state(4, 4);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(1, 0), 1);
+    state.GenerateTile(GameState::Position(2, 0), 2);
+    state.GenerateTile(GameState::Position(3, 0), 3);
+    ExpectimaxPlayer player(&num_tile_, 1);
+    GameState::Direction move = GameState::Direction::LEFT;
+    ASSERT_TRUE(player.Play(state, &move));
+    EXPECT_EQ(move, GameState::Direction::UP);
+
+    GameState big(5, 5);
+    big.GenerateTile(GameState::Position(0, 4), 1);
+    big.GenerateTile(GameState::Position(1, 4), 1);
+    ASSERT_TRUE(player.Play(big, &move));
+    EXPECT_EQ(move, GameState::Direction::UP);
+}
+
+TEST_F(ExpectimaxPlayerTest, PlayBitBoard) {
+    ExpectimaxPlayer player(&gradient_, 2);
+    EXPECT_GE(PlayGame(&player, GameState(4, 4), 12, 300), 8);
+}
+
+TEST_F(ExpectimaxPlayerTest, TranspositionTable) {
+    // the table saves nodes without changing any move
+    ExpectimaxPlayer plain(&gradient_, 3);
+    ExpectimaxPlayer cached(&gradient_, 3, 4);
+    EXPECT_EQ(plain.table(), nullptr);
+    ASSERT_NE(cached.table(), nullptr);
+    EXPECT_THROW(ExpectimaxPlayer(&num_tile_, 256, 1), std::invalid_argument);
+
+    std::mt19937_64 engine(7);
+    GameState state(4, 4);
+    uint64_t reused = 0, nodes = 0, fresh_nodes = 0;
+    for (uint32_t turn = 0; turn < 20; turn++) {
+        uint32_t count = state.CountEmptyTiles();
+        state.GenerateTile(state.GetEmptyTile(engine() % count), 1);
+        GameState::Direction move, cached_move;
+        ASSERT_TRUE(plain.Play(state, &move));
+        ASSERT_TRUE(cached.Play(state, &cached_move));
+        EXPECT_EQ(cached_move, move);
+        EXPECT_LT(cached.nodes(), plain.nodes());
+        EXPECT_EQ(plain.reused(), 0u);
+        reused += cached.reused();
+        nodes += cached.nodes();
+
+        // the same search with an empty table
+        ExpectimaxPlayer fresh(&gradient_, 3, 4);
+        ASSERT_TRUE(fresh.Play(state, &cached_move));
+        EXPECT_EQ(fresh.reused(), 0u);
+        fresh_nodes += fresh.nodes();
+        state.Move(move);
+    }
+    // results of earlier moves decide nodes, which are not searched again
+    EXPECT_GT(reused, 0u);
+    EXPECT_LT(nodes, fresh_nodes);
+    EXPECT_GT(cached.table()->stats().hits, 0u);
+    EXPECT_GT(cached.table()->stats().stores, 0u);
+
+    // with a threshold, the table saves nodes within a play, and no result of
+    // an earlier play is used
+    ExpectimaxPlayer cut(&gradient_, 3, 0, 1e-3);
+    ExpectimaxPlayer cut_cached(&gradient_, 3, 4, 1e-3);
+    state = GameState(4, 4);
+    for (uint32_t turn = 0; turn < 20; turn++) {
+        uint32_t count = state.CountEmptyTiles();
+        state.GenerateTile(state.GetEmptyTile(engine() % count), 1);
+        GameState::Direction move, cached_move;
+        ASSERT_TRUE(cut.Play(state, &move));
+        ASSERT_TRUE(cut_cached.Play(state, &cached_move));
+        EXPECT_EQ(cached_move, move);
+        EXPECT_LT(cut_cached.nodes(), cut.nodes());
+        EXPECT_EQ(cut_cached.reused(), 0u);
+        state.Move(move);
+    }
+}
+
+TEST_F(ExpectimaxPlayerTest, ProbabilityCutoff) {
+    EXPECT_THROW(ExpectimaxPlayer(&num_tile_, 2, 0, -0.1),
+                 std::invalid_argument);
+    EXPECT_THROW(ExpectimaxPlayer(&num_tile_, 2, 0, 1.5),
+                 std::invalid_argument);
+
+    // [[2, _, _, _],
+    //  [_, _, _, _],
+    //  [_, 4, _, _],
+    //  [_, _, _, 2]]
+    GameState state(4, 4);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(2, 1), 2);
+    state.GenerateTile(GameState::Position(3, 3), 1);
+    GameState::Direction move;
+    ExpectimaxPlayer full(&gradient_, 3);
+    ASSERT_TRUE(full.Play(state, &move));
+    EXPECT_EQ(full.cutoffs(), 0u);
+
+    // every spawn of 14 empty tiles has probability below 0.1 after one move
+    ExpectimaxPlayer cut(&gradient_, 3, 0, 0.1);
+    ASSERT_TRUE(cut.Play(state, &move));
+    EXPECT_GT(cut.cutoffs(), 0u);
+    EXPECT_LT(cut.nodes(), full.nodes() / 10);
+
+    ExpectimaxPlayer loose(&gradient_, 3, 0, 1e-4);
+    ASSERT_TRUE(loose.Play(state, &move));
+    EXPECT_GT(loose.cutoffs(), 0u);
+    EXPECT_LT(loose.nodes(), full.nodes());
+    EXPECT_GT(loose.nodes(), cut.nodes());
+}
+
+TEST_F(ExpectimaxPlayerTest, StarPruning) {
+    // pruning chooses the same moves as the full search with fewer nodes
+    _2048::ai::eval::SumExponents sum_exponents;
+    for (const EvaluationFunction *eval :
+            std::vector<const EvaluationFunction *>{&num_tile_, &gradient_,
+                                                    &sum_exponents}) {
+        ExpectimaxPlayer full(eval, 3);
+        ExpectimaxPlayer pruned(eval, 3, 0, 0, true);
+        ExpectimaxPlayer cached(eval, 3, 4, 0, true);
+        std::mt19937_64 engine(5);
+        GameState state(4, 4);
+        uint64_t full_nodes = 0, pruned_nodes = 0;
+        for (uint32_t turn = 0; turn < 20; turn++) {
+            uint32_t count = state.CountEmptyTiles();
+            state.GenerateTile(state.GetEmptyTile(engine() % count), 1);
+            GameState::Direction move, pruned_move, cached_move;
+            ASSERT_TRUE(full.Play(state, &move));
+            ASSERT_TRUE(pruned.Play(state, &pruned_move));
+            ASSERT_TRUE(cached.Play(state, &cached_move));
+            EXPECT_EQ(pruned_move, move);
+            EXPECT_EQ(cached_move, move);
+            EXPECT_LE(pruned.nodes(), full.nodes());
+            full_nodes += full.nodes();
+            pruned_nodes += pruned.nodes();
+            state.Move(move);
+        }
+        EXPECT_LT(pruned_nodes, full_nodes);
+    }
+}
+
+TEST_F(ExpectimaxPlayerTest, Parallel) {
+    // the moves do not depend on the number of threads, with or without a
+    // table, pruning and a probability threshold
+    ExpectimaxPlayer serial(&gradient_, 3, 0, 1e-3);
+    ExpectimaxPlayer parallel(&gradient_, 3, 0, 1e-3, false, 4);
+    ExpectimaxPlayer cached(&gradient_, 3, 8, 1e-3, true, 3);
+    ExpectimaxPlayer cached_serial(&gradient_, 3, 16, 1e-3);
+    ThreadPool pool(3);
+    ExpectimaxPlayer shared(&gradient_, 3, 0, 1e-3, false, pool);
+    ExpectimaxPlayer pruned(&gradient_, 3, 0, 0, true, pool);
+    ExpectimaxPlayer pruned_serial(&gradient_, 3, 0, 0, true);
+    ExpectimaxPlayer hardware(&gradient_, 3, 0, 0, false, 0);
+    EXPECT_EQ(serial.threads(), 1u);
+    EXPECT_EQ(hardware.threads(), std::thread::hardware_concurrency());
+    EXPECT_EQ(parallel.threads(), 4u);
+    EXPECT_EQ(shared.threads(), 3u);
+    ASSERT_NE(cached.table(2), nullptr);
+
+    std::mt19937_64 engine(9);
+    GameState state(4, 4);
+    for (uint32_t turn = 0; turn < 50; turn++) {
+        uint32_t count = state.CountEmptyTiles();
+        state.GenerateTile(state.GetEmptyTile(engine() % count), 1);
+        GameState::Direction move, parallel_move, cached_move, shared_move;
+        GameState::Direction pruned_move, pruned_serial_move;
+        GameState::Direction cached_serial_move;
+        ASSERT_TRUE(serial.Play(state, &move));
+        ASSERT_TRUE(parallel.Play(state, &parallel_move));
+        ASSERT_TRUE(cached.Play(state, &cached_move));
+        ASSERT_TRUE(cached_serial.Play(state, &cached_serial_move));
+        ASSERT_TRUE(shared.Play(state, &shared_move));
+        ASSERT_TRUE(pruned.Play(state, &pruned_move));
+        ASSERT_TRUE(pruned_serial.Play(state, &pruned_serial_move));
+        EXPECT_EQ(parallel_move, move);
+        EXPECT_EQ(cached_move, move);
+        EXPECT_EQ(cached_serial_move, move);
+        EXPECT_EQ(shared_move, move);
+        EXPECT_EQ(pruned_move, pruned_serial_move);
+        EXPECT_EQ(parallel.nodes(), serial.nodes());
+        EXPECT_EQ(parallel.cutoffs(), serial.cutoffs());
+        EXPECT_EQ(shared.nodes(), serial.nodes());
+        state.Move(move);
+    }
+
+    GameState::Direction move = GameState::Direction::LEFT;
+    GameState over(2, 2);
+    over.GenerateTile(GameState::Position(0, 0), 1);
+    over.GenerateTile(GameState::Position(0, 1), 2);
+    over.GenerateTile(GameState::Position(1, 0), 3);
+    over.GenerateTile(GameState::Position(1, 1), 4);
+    EXPECT_FALSE(parallel.Play(over, &move));
+    EXPECT_EQ(move, GameState::Direction::LEFT);
+}
+
+TEST_F(ExpectimaxPlayerTest, SearchLimits) {
+    GameState state(4, 4);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(3, 2), 2);
+    GameState::Direction move, full_move;
+
+    // a lower depth, searched at once
+    ExpectimaxPlayer player(&gradient_, 8, 4);
+    ExpectimaxPlayer shallow(&gradient_, 2, 4);
+    _2048::SearchLimits limits;
+    limits.depth = 2;
+    ASSERT_TRUE(player.Play(state, &move, limits));
+    ASSERT_TRUE(shallow.Play(state, &full_move));
+    EXPECT_EQ(move, full_move);
+    EXPECT_EQ(player.searched_depth(), 2u);
+    EXPECT_EQ(player.nodes(), shallow.nodes());
+
+    // iterative deepening to a deadline, past which depth 1 still completes
+    const auto start = std::chrono::steady_clock::now();
+    limits = _2048::SearchLimits::Within(std::chrono::milliseconds(20));
+    ASSERT_TRUE(player.Play(state, &move, limits));
+    EXPECT_LT(std::chrono::steady_clock::now() - start,
+              std::chrono::seconds(2));
+    EXPECT_GE(player.searched_depth(), 1u);
+    EXPECT_LT(player.searched_depth(), 8u);
+    limits.deadline = std::chrono::steady_clock::now();
+    ASSERT_TRUE(player.Play(state, &move, limits));
+    EXPECT_EQ(player.searched_depth(), 1u);
+
+    // a node limit, also across threads
+    ExpectimaxPlayer parallel(&gradient_, 8, 4, 0, false, 3);
+    limits = _2048::SearchLimits();
+    limits.nodes = 20000;
+    for (ExpectimaxPlayer *limited : {&player, &parallel}) {
+        ASSERT_TRUE(limited->Play(state, &move, limits));
+        EXPECT_GE(limited->searched_depth(), 1u);
+        EXPECT_LT(limited->searched_depth(), 8u);
+        EXPECT_LT(limited->nodes(), 20000u + 3 * 2048);
+    }
+
+    // a raised stop flag ends the search after the first iteration
+    const std::atomic<bool> stop(true);
+    _2048::SearchLimits stopped;
+    stopped.stop = &stop;
+    ASSERT_TRUE(player.Play(state, &move, stopped));
+    EXPECT_EQ(player.searched_depth(), 1u);
+
+    // a complete iteration finds the same move as the search at that depth
+    ExpectimaxPlayer deep(&gradient_, 3, 4);
+    ASSERT_TRUE(deep.Play(state, &full_move));
+    limits.nodes = deep.nodes() * 100;
+    limits.depth = 3;
+    ASSERT_TRUE(player.Play(state, &move, limits));
+    EXPECT_EQ(player.searched_depth(), 3u);
+    EXPECT_EQ(move, full_move);
+}
+
+TEST_F(ExpectimaxPlayerTest, PlayGameState) {
+    ExpectimaxPlayer player(&num_tile_, 2);
+    PlayGame(&player, GameState(3, 3), 33, 200);
+    PlayGame(&player, GameState(5, 5), 55, 50);
+
+    // a cutoff makes deep searches of large boards affordable
+    ExpectimaxPlayer deep(&num_tile_, 4, 16, 0.01);
+    PlayGame(&deep, GameState(10, 10), 1010, 10);
+}
+
+}  // namespace
@@ -0,0 +1,164 @@
+#include "ai/mcts_player.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+
+#include "game_state.h"
+#include "ai/thread_pool.h"
+#include "play_game.h"
+
+namespace {
+
+using _2048::GameState;
+using _2048::ai::MctsPlayer;
+using std::chrono::milliseconds;
+
+// play a game against random spawns, checking every move
+// return the largest power reached
+uint8_t PlayGame(MctsPlayer *player, GameState state, uint64_t seed,
+                 uint32_t turns) {
+    return _2048::ai::test::PlayGame(player, state, seed, turns, [player] {
+        return player->nodes();
+    });
+}
+
+TEST(MctsPlayerTest, Construct) {
+    EXPECT_THROW(MctsPlayer(0), std::invalid_argument);
+    EXPECT_THROW(MctsPlayer(10, milliseconds(0), 1, 0, 0),
+                 std::invalid_argument);
+    EXPECT_THROW(MctsPlayer(10, milliseconds(0), 1, 0, 1, -1),
+                 std::invalid_argument);
+    EXPECT_EQ(MctsPlayer(10).threads(), 1u);
+    EXPECT_EQ(MctsPlayer(0, milliseconds(10), 3).threads(), 3u);
+}
+
+TEST(MctsPlayerTest, NoMove) {
+    // [[2, 4],
+    //  [8, 16]]
+    GameState state(2, 2);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(0, 1), 2);
+    state.GenerateTile(GameState::Position(1, 0), 3);
+    state.GenerateTile(GameState::Position(1, 1), 4);
+    MctsPlayer player(10);
+    GameState::Direction move = GameState::Direction::LEFT;
+    EXPECT_FALSE(player.Play(state, &move));
+    EXPECT_EQ(move, GameState::Direction::LEFT);
+}
+
+TEST(MctsPlayerTest, Budget) {
+    GameState state(4, 4);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(2, 3), 1);
+    GameState::Direction move;
+
+    MctsPlayer counted(300);
+    ASSERT_TRUE(counted.Play(state, &move));
+    EXPECT_EQ(counted.playouts(), 300u);
+    EXPECT_GT(counted.nodes(), 4u);
+    EXPECT_LE(counted.nodes(), 1u + 2 * 300);
+
+    // the same seed plays the same moves
+    MctsPlayer again(300);
+    GameState::Direction again_move;
+    ASSERT_TRUE(again.Play(state, &again_move));
+    EXPECT_EQ(again_move, move);
+
+    MctsPlayer timed(0, milliseconds(20));
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(timed.Play(state, &move));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, milliseconds(20));
+    EXPECT_GT(timed.playouts(), 0u);
+
+    // limits of the play tighten those of the player
+    _2048::SearchLimits limits;
+    limits.nodes = 50;
+    ASSERT_TRUE(counted.Play(state, &move, limits));
+    EXPECT_EQ(counted.playouts(), 50u);
+    ASSERT_TRUE(timed.Play(state, &move, limits));
+    EXPECT_LE(timed.playouts(), 50u);
+    limits = _2048::SearchLimits::Within(milliseconds(0));
+    ASSERT_TRUE(counted.Play(state, &move, limits));
+    EXPECT_EQ(counted.playouts(), 0u);
+    EXPECT_TRUE(state.GetPossibleMoveMask() & GameState::ToMask(move));
+}
+
+TEST(MctsPlayerTest, Parallel) {
+    // threads share the playout budget and the tree
+    MctsPlayer player(200, milliseconds(0), 3);
+    EXPECT_GE(PlayGame(&player, GameState(4, 4), 31, 100), 6);
+    EXPECT_EQ(player.playouts(), 200u);
+
+    // and so do the threads of a shared pool
+    _2048::ai::ThreadPool pool(2);
+    MctsPlayer shared(200, milliseconds(0), pool);
+    EXPECT_EQ(shared.threads(), 2u);
+    EXPECT_GE(PlayGame(&shared, GameState(4, 4), 31, 100), 6);
+    EXPECT_EQ(shared.playouts(), 200u);
+}
+
+TEST(MctsPlayerTest, FullTree) {
+    // a tree of one megabyte fills up, and the search goes on
+    // [[2,    4,  8,   16],
+    //  [32,   64, 128, 256],
+    //  [2,    4,  8,   16],
+    //  [_,    _,  _,   _]]
+    MctsPlayer player(60000, milliseconds(0), 1, 7, 1);
+    GameState state(4, 4);
+    for (uint32_t c = 0; c < 4; c++) {
+        state.GenerateTile(GameState::Position(0, c), c + 1);
+        state.GenerateTile(GameState::Position(1, c), c + 5);
+        state.GenerateTile(GameState::Position(2, c), c + 1);
+    }
+    GameState::Direction move;
+    ASSERT_TRUE(player.Play(state, &move));
+    EXPECT_EQ(player.playouts(), 60000u);
+    EXPECT_LT(player.nodes(), 60000u);
+}
+
+TEST(MctsPlayerTest, Reuse) {
+    // the subtree of the position after the move played and the new tile is
+    // kept for the next move
+    MctsPlayer player(2000);
+    std::mt19937_64 engine(3);
+    GameState state(4, 4);
+    uint32_t reused = 0;
+    for (uint32_t turn = 0; turn < 10; turn++) {
+        uint32_t count = state.CountEmptyTiles();
+        state.GenerateTile(state.GetEmptyTile(engine() % count), 1);
+        GameState::Direction move;
+        ASSERT_TRUE(player.Play(state, &move));
+        if (turn == 0) {
+            EXPECT_EQ(player.reused(), 0u);
+        }
+        EXPECT_LE(player.reused(), player.nodes());
+        EXPECT_EQ(player.playouts(), 2000u);
+        if (player.reused() > 0)
+            reused++;
+        state.Move(move);
+    }
+    EXPECT_GE(reused, 8u);
+
+    // any other position starts a new tree
+    GameState other(4, 4);
+    other.GenerateTile(GameState::Position(3, 3), 2);
+    GameState::Direction move;
+    ASSERT_TRUE(player.Play(other, &move));
+    EXPECT_EQ(player.reused(), 0u);
+}
+
+TEST(MctsPlayerTest, PlayBitBoard) {
+    MctsPlayer player(100);
+    EXPECT_GE(PlayGame(&player, GameState(4, 4), 12, 400), 8);
+}
+
+TEST(MctsPlayerTest, PlayGameState) {
+    MctsPlayer player(20);
+    PlayGame(&player, GameState(3, 3), 33, 100);
+    PlayGame(&player, GameState(5, 5), 55, 20);
+}
+
+}  // namespace
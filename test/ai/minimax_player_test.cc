@@ -0,0 +1,199 @@
+#include "ai/minimax_player.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+#include "game_state.h"
+#include "bit_board_4x4.h"
+#include "ai/eval/eval_func.h"
+#include "ai/eval/num_tile.h"
+#include "ai/eval/weight_table/gradient_exponential_4x4.h"
+
+namespace {
+
+using _2048::BitBoard4x4;
+using _2048::GameState;
+using _2048::ai::MinimaxPlayer;
+using _2048::ai::eval::EvaluationFunction;
+
+// plain minimax without pruning, counting nodes like `MinimaxPlayer`
+int64_t PlainMax(const EvaluationFunction &eval, BitBoard4x4 board,
+                 uint32_t depth, uint64_t *nodes);
+
+int64_t PlainMin(const EvaluationFunction &eval, BitBoard4x4 board,
+                 uint32_t depth, uint64_t *nodes) {
+    ++*nodes;
+    int64_t value = EvaluationFunction::kPosInf;
+    for (uint32_t i = 0; i < board.CountEmptyTiles(); i++)
+        for (uint8_t power = 1; power <= 2; power++) {
+            BitBoard4x4 child(board);
+            child.GenerateTile(board.GetEmptyTile(i), power);
+            value = std::min(value, PlainMax(eval, child, depth - 1, nodes));
+        }
+    return value;
+}
+
+int64_t PlainMax(const EvaluationFunction &eval, BitBoard4x4 board,
+                 uint32_t depth, uint64_t *nodes) {
+    ++*nodes;
+    if (depth == 0)
+        return eval(board);
+    if (board.GetPossibleMoveMask() == 0)
+        return EvaluationFunction::kOver;
+    int64_t value = EvaluationFunction::kNegInf;
+    for (auto dir : board.GetPossibleMoves()) {
+        BitBoard4x4 child(board);
+        child.Move(dir);
+        value = std::max(value, PlainMin(eval, child, depth, nodes));
+    }
+    return value;
+}
+
+class MinimaxPlayerTest : public testing::Test {
+ protected:
+    _2048::ai::eval::NumTile num_tile_;
+    _2048::ai::eval::weight_table::GradientExponential4x4 gradient_;
+    GameState state_ = GameState(4, 4);
+
+    void SetUp() override {
+        // [[_,    2,  _,  4],
+        //  [_,    2,  _,  _],
+        //  [8,    4,  4,  _],
+        //  [2048, 64, 32, _]]
+        state_.GenerateTile(GameState::Position(0, 1), 1);
+        state_.GenerateTile(GameState::Position(0, 3), 2);
+        state_.GenerateTile(GameState::Position(1, 1), 1);
+        state_.GenerateTile(GameState::Position(2, 0), 3);
+        state_.GenerateTile(GameState::Position(2, 1), 2);
+        state_.GenerateTile(GameState::Position(2, 2), 2);
+        state_.GenerateTile(GameState::Position(3, 0), 11);
+        state_.GenerateTile(GameState::Position(3, 1), 6);
+        state_.GenerateTile(GameState::Position(3, 2), 5);
+    }
+};
+
+TEST_F(MinimaxPlayerTest, Construct) {
+    EXPECT_THROW(MinimaxPlayer(nullptr, 2), std::invalid_argument);
+    EXPECT_THROW(MinimaxPlayer(&num_tile_, 0), std::invalid_argument);
+    EXPECT_THROW(MinimaxPlayer(&num_tile_, 256), std::invalid_argument);
+}
+
+TEST_F(MinimaxPlayerTest, NoMove) {
+    GameState state(2, 2);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(0, 1), 2);
+    state.GenerateTile(GameState::Position(1, 0), 3);
+    state.GenerateTile(GameState::Position(1, 1), 4);
+    MinimaxPlayer player(&num_tile_, 2);
+    GameState::Direction move = GameState::Direction::LEFT;
+    EXPECT_FALSE(player.Play(state, &move));
+    EXPECT_EQ(move, GameState::Direction::LEFT);
+}
+
+TEST_F(MinimaxPlayerTest, SameValueAsPlainMinimax) {
+    for (uint32_t depth = 1; depth <= 3; depth++) {
+        MinimaxPlayer player(&gradient_, depth);
+        GameState::Direction move;
+        ASSERT_TRUE(player.Play(state_, &move));
+        EXPECT_EQ(player.depth(), depth);
+
+        uint64_t plain_nodes = 0;
+        const int64_t value = PlainMax(gradient_, BitBoard4x4(state_), depth,
+                                       &plain_nodes);
+        EXPECT_EQ(player.value(), value);
+        BitBoard4x4 child(state_);
+        child.Move(move);
+        uint64_t nodes = 0;
+        EXPECT_EQ(PlainMin(gradient_, child, depth, &nodes), value);
+        if (depth > 1) {
+            EXPECT_LT(player.nodes(), plain_nodes);
+            EXPECT_GT(player.table().stats().hits, 0u);
+            EXPECT_EQ(player.reused(), 0u);
+
+            // playing again finds the results of the first play
+            const uint64_t first_nodes = player.nodes();
+            ASSERT_TRUE(player.Play(state_, &move));
+            EXPECT_EQ(player.value(), value);
+            EXPECT_GT(player.reused(), 0u);
+            EXPECT_LT(player.nodes(), first_nodes);
+        }
+    }
+}
+
+TEST_F(MinimaxPlayerTest, TimeLimit) {
+    MinimaxPlayer player(&gradient_, 100, std::chrono::milliseconds(20));
+    GameState::Direction move;
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(player.Play(state_, &move));
+    EXPECT_LT(std::chrono::steady_clock::now() - start,
+              std::chrono::seconds(2));
+    EXPECT_GE(player.depth(), 1u);
+    EXPECT_LT(player.depth(), 100u);
+    EXPECT_GT(player.nodes(), 0u);
+    EXPECT_GT(player.NodesPerSecond(), 0);
+}
+
+TEST_F(MinimaxPlayerTest, SearchLimits) {
+    MinimaxPlayer player(&gradient_, 100);
+    GameState::Direction move;
+    _2048::SearchLimits limits;
+    limits.depth = 3;
+    ASSERT_TRUE(player.Play(state_, &move, limits));
+    EXPECT_EQ(player.depth(), 3u);
+
+    // the deadline of the play and the time limit of the player, whichever
+    // comes first
+    MinimaxPlayer timed(&gradient_, 100, std::chrono::seconds(100));
+    const auto start = std::chrono::steady_clock::now();
+    limits = _2048::SearchLimits::Within(std::chrono::milliseconds(20));
+    ASSERT_TRUE(timed.Play(state_, &move, limits));
+    EXPECT_LT(std::chrono::steady_clock::now() - start,
+              std::chrono::seconds(2));
+    EXPECT_GE(timed.depth(), 1u);
+    EXPECT_LT(timed.depth(), 100u);
+
+    limits = _2048::SearchLimits();
+    limits.nodes = 10000;
+    ASSERT_TRUE(player.Play(state_, &move, limits));
+    EXPECT_GE(player.depth(), 1u);
+    EXPECT_LT(player.depth(), 100u);
+    // the limits are checked every 1024 nodes
+    EXPECT_LT(player.nodes(), 10000u + 2048);
+
+    // a raised stop flag ends the search at the first check after the first
+    // iteration
+    const std::atomic<bool> stop(true);
+    limits = _2048::SearchLimits();
+    limits.stop = &stop;
+    ASSERT_TRUE(player.Play(state_, &move, limits));
+    EXPECT_GE(player.depth(), 1u);
+    EXPECT_LT(player.depth(), 100u);
+    EXPECT_LT(player.nodes(), 2048u);
+}
+
+TEST_F(MinimaxPlayerTest, PlayGameState) {
+    // 3 by 3 games are searched on `GameState`
+    std::mt19937_64 engine(3);
+    MinimaxPlayer player(&num_tile_, 3);
+    GameState state(3, 3);
+    for (uint32_t turn = 0; turn < 100; turn++) {
+        uint32_t count = state.CountEmptyTiles();
+        if (count == 0)
+            break;
+        state.GenerateTile(state.GetEmptyTile(engine() % count), 1);
+        GameState::Direction move;
+        GameState::DirectionMask mask = state.GetPossibleMoveMask();
+        ASSERT_EQ(player.Play(state, &move), mask != 0);
+        if (mask == 0)
+            break;
+        ASSERT_TRUE(mask & GameState::ToMask(move));
+        state.Move(move);
+    }
+}
+
+}  // namespace
@@ -0,0 +1,55 @@
+#ifndef _TEST_AI_PLAYGAME_H_
+#define _TEST_AI_PLAYGAME_H_
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+
+#include "game_state.h"
+#include "player.h"
+
+namespace _2048 {
+namespace ai {
+namespace test {
+
+/**
+ * Play a game against random spawns, checking that every move is legal and
+ * that the player did some work for it.
+ * @tparam Work a callable returning the work of the last play of the player,
+ *      such as its number of nodes
+ * @param player the player
+ * @param state the state to start from
+ * @param seed the seed of the spawns
+ * @param turns the maximum number of turns
+ * @param work the work of the last play
+ * @return the largest power reached
+ */
+template <typename Work>
+uint8_t PlayGame(Player *player, GameState state, uint64_t seed,
+                 uint32_t turns, const Work &work) {
+    std::mt19937_64 engine(seed);
+    for (uint32_t turn = 0; turn < turns; turn++) {
+        uint32_t count = state.CountEmptyTiles();
+        if (count == 0)
+            break;
+        state.GenerateTile(state.GetEmptyTile(engine() % count),
+                           engine() % 10 == 0 ? 2 : 1);
+
+        GameState::Direction move = GameState::Direction::UP;
+        GameState::DirectionMask mask = state.GetPossibleMoveMask();
+        bool played = player->Play(state, &move);
+        EXPECT_EQ(played, mask != 0);
+        if (!played)
+            break;
+        EXPECT_TRUE(mask & GameState::ToMask(move));
+        EXPECT_GT(work(), 0u);
+        state.Move(move);
+    }
+    return state.GetMaxPower();
+}
+
+}  // namespace test
+}  // namespace ai
+}  // namespace _2048
+
+#endif  // _TEST_AI_PLAYGAME_H_
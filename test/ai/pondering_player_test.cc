@@ -0,0 +1,108 @@
+#include "ai/pondering_player.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+#include "game_state.h"
+#include "player.h"
+#include "ai/expectimax_player.h"
+#include "ai/eval/weight_table/gradient_exponential_4x4.h"
+
+namespace {
+
+using _2048::GameState;
+using _2048::ai::ExpectimaxPlayer;
+using _2048::ai::PonderingPlayer;
+
+// a player that passes plays on, and records the last depth limit it is given
+class DepthRecorder : public _2048::Player {
+ public:
+    explicit DepthRecorder(Player *player) : player_(player), depth_(0) { }
+
+    bool Play(const GameState &state, GameState::Direction *move) override {
+        return player_->Play(state, move);
+    }
+
+    bool Play(const GameState &state, GameState::Direction *move,
+              const _2048::SearchLimits &limits) override {
+        // pondering searches have no depth limit, so only the caller's
+        // plays write `depth_`
+        if (limits.depth != 0)
+            depth_ = limits.depth;
+        return player_->Play(state, move, limits);
+    }
+
+    uint32_t depth() const noexcept { return depth_; }
+
+ private:
+    Player *player_;
+    uint32_t depth_;
+};
+
+class PonderingPlayerTest : public testing::Test {
+ protected:
+    _2048::ai::eval::weight_table::GradientExponential4x4 gradient_;
+};
+
+TEST_F(PonderingPlayerTest, Construct) {
+    EXPECT_THROW(PonderingPlayer(nullptr), std::invalid_argument);
+}
+
+TEST_F(PonderingPlayerTest, SameMoves) {
+    // pondered answers are those of the player searching on its own
+    ExpectimaxPlayer inner(&gradient_, 2);
+    ExpectimaxPlayer reference(&gradient_, 2);
+    PonderingPlayer player(&inner);
+    std::mt19937_64 engine(5);
+    GameState state(4, 4);
+    uint32_t turns = 0;
+    for (; turns < 40; turns++) {
+        uint32_t count = state.CountEmptyTiles();
+        if (count == 0)
+            break;
+        state.GenerateTile(state.GetEmptyTile(engine() % count),
+                           engine() % 10 == 0 ? 2 : 1);
+        player.Wait();
+        GameState::Direction move, expected;
+        const bool played = player.Play(state, &move);
+        ASSERT_EQ(played, reference.Play(state, &expected));
+        if (!played)
+            break;
+        EXPECT_EQ(move, expected);
+        state.Move(move);
+    }
+    EXPECT_EQ(player.misses(), 1u);
+    EXPECT_EQ(player.hits() + player.misses(), turns);
+}
+
+TEST_F(PonderingPlayerTest, Miss) {
+    ExpectimaxPlayer search(&gradient_, 3);
+    DepthRecorder inner(&search);
+    PonderingPlayer player(&inner);
+    GameState state(4, 4);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(0, 1), 1);
+    GameState::Direction move;
+    ASSERT_TRUE(player.Play(state, &move));
+
+    // a state that was not pondered, and limits that pondering cannot meet
+    GameState other(4, 4);
+    other.GenerateTile(GameState::Position(3, 3), 2);
+    ASSERT_TRUE(player.Play(other, &move));
+    EXPECT_TRUE(other.GetPossibleMoveMask() & GameState::ToMask(move));
+    player.Wait();
+    GameState next(other);
+    next.Move(move);
+    next.GenerateTile(next.GetEmptyTile(0), 1);
+    _2048::SearchLimits limits;
+    limits.depth = 1;
+    ASSERT_TRUE(player.Play(next, &move, limits));
+    EXPECT_EQ(inner.depth(), 1u);
+    EXPECT_EQ(player.hits(), 0u);
+    EXPECT_EQ(player.misses(), 3u);
+    player.Stop();
+}
+
+}  // namespace
@@ -0,0 +1,137 @@
+#include "ai/rollout_player.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <stdexcept>
+
+#include "game_state.h"
+#include "ai/thread_pool.h"
+#include "play_game.h"
+
+namespace {
+
+using _2048::GameState;
+using _2048::ai::RolloutPlayer;
+using std::chrono::milliseconds;
+
+// play a game against random spawns, checking every move
+// return the largest power reached
+uint8_t PlayGame(RolloutPlayer *player, GameState state, uint64_t seed,
+                 uint32_t turns) {
+    return _2048::ai::test::PlayGame(player, state, seed, turns, [player] {
+        return player->rollouts();
+    });
+}
+
+// a 4 by 4 state early in a game
+GameState Opening() {
+    GameState state(4, 4);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(2, 3), 1);
+    return state;
+}
+
+TEST(RolloutPlayerTest, Construct) {
+    EXPECT_THROW(RolloutPlayer(0), std::invalid_argument);
+    EXPECT_EQ(RolloutPlayer(10).threads(), 1u);
+    EXPECT_EQ(RolloutPlayer(10, RolloutPlayer::Objective::SCORE, 3).threads(),
+              3u);
+}
+
+TEST(RolloutPlayerTest, NoMove) {
+    // [[2, 4],
+    //  [8, 16]]
+    GameState state(2, 2);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(0, 1), 2);
+    state.GenerateTile(GameState::Position(1, 0), 3);
+    state.GenerateTile(GameState::Position(1, 1), 4);
+    RolloutPlayer player(10);
+    GameState::Direction move = GameState::Direction::LEFT;
+    EXPECT_FALSE(player.Play(state, &move));
+    EXPECT_EQ(move, GameState::Direction::LEFT);
+    EXPECT_EQ(player.rollouts(), 0u);
+}
+
+TEST(RolloutPlayerTest, Rollouts) {
+    // [[_, _, _, _],
+    //  [_, 2, 2, _],
+    //  [_, _, _, _],
+    //  [_, _, _, _]]
+    // every move is legal
+    GameState state(4, 4);
+    state.GenerateTile(GameState::Position(1, 1), 1);
+    state.GenerateTile(GameState::Position(1, 2), 1);
+    RolloutPlayer player(100);
+    GameState::Direction move;
+    ASSERT_TRUE(player.Play(state, &move));
+    EXPECT_EQ(player.rollouts(), 400u);
+    EXPECT_GT(player.moves(), 400u);
+    EXPECT_GT(player.MovesPerSecond(), 0);
+
+    // the same seed plays the same move, whatever the number of threads
+    for (uint32_t threads : {1, 2, 3}) {
+        RolloutPlayer again(100, RolloutPlayer::Objective::SCORE, threads);
+        GameState::Direction again_move;
+        ASSERT_TRUE(again.Play(state, &again_move));
+        EXPECT_EQ(again_move, move);
+        EXPECT_EQ(again.rollouts(), 400u);
+        EXPECT_EQ(again.moves(), player.moves());
+    }
+    _2048::ai::ThreadPool pool(2);
+    RolloutPlayer shared(100, RolloutPlayer::Objective::SCORE, pool);
+    GameState::Direction shared_move;
+    EXPECT_EQ(shared.threads(), 2u);
+    ASSERT_TRUE(shared.Play(state, &shared_move));
+    EXPECT_EQ(shared_move, move);
+    EXPECT_EQ(shared.moves(), player.moves());
+}
+
+TEST(RolloutPlayerTest, Limits) {
+    GameState state = Opening();
+    RolloutPlayer player(1000);
+    GameState::Direction move;
+
+    // a node limit caps the games of all moves
+    _2048::SearchLimits limits;
+    limits.nodes = 200;
+    ASSERT_TRUE(player.Play(state, &move, limits));
+    EXPECT_LE(player.rollouts(), 200u);
+    EXPECT_GE(player.rollouts(), 200u - 4);
+
+    // every batch plays one game after the deadline
+    limits = _2048::SearchLimits::Within(milliseconds(0));
+    ASSERT_TRUE(player.Play(state, &move, limits));
+    const uint32_t batches = (1000 + RolloutPlayer::kBatch - 1) /
+                             RolloutPlayer::kBatch;
+    EXPECT_EQ(player.rollouts(),
+              batches * __builtin_popcount(state.GetPossibleMoveMask()));
+    EXPECT_TRUE(state.GetPossibleMoveMask() & GameState::ToMask(move));
+
+    std::atomic<bool> stop(true);
+    _2048::SearchLimits stopped;
+    stopped.stop = &stop;
+    ASSERT_TRUE(player.Play(state, &move, stopped));
+    EXPECT_EQ(player.rollouts(),
+              batches * __builtin_popcount(state.GetPossibleMoveMask()));
+}
+
+TEST(RolloutPlayerTest, PlayBitBoard) {
+    RolloutPlayer player(100, RolloutPlayer::Objective::SCORE, 2);
+    EXPECT_GE(PlayGame(&player, GameState(4, 4), 12, 300), 8);
+}
+
+TEST(RolloutPlayerTest, PlayMoves) {
+    RolloutPlayer player(100, RolloutPlayer::Objective::MOVES);
+    EXPECT_GE(PlayGame(&player, GameState(4, 4), 21, 300), 8);
+}
+
+TEST(RolloutPlayerTest, PlayGameState) {
+    RolloutPlayer player(20);
+    PlayGame(&player, GameState(3, 3), 33, 100);
+    PlayGame(&player, GameState(5, 5), 55, 20);
+}
+
+}  // namespace
@@ -0,0 +1,155 @@
+#include "ai/solver.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <stdexcept>
+
+#include "game_state.h"
+#include "ai/value_table.h"
+
+namespace {
+
+using _2048::GameState;
+using _2048::ai::Solver;
+using _2048::ai::TableKeys;
+using _2048::ai::ValueTable;
+using Objective = Solver::Objective;
+
+// expectimax over `GameState`, remembering the positions after a move
+class Reference {
+ public:
+    explicit Reference(Objective objective) : objective_(objective) { }
+
+    // value of a position before a move
+    double Best(const GameState &state) {
+        double best = 0;
+        for (GameState::Direction dir : GameState::kDirections) {
+            GameState after(state);
+            const GameState::MoveResult result = after.Move(dir);
+            if (result.moved)
+                best = std::max(best, (objective_ == Objective::MOVES ?
+                                       1 : result.score) + Expect(after));
+        }
+        return best;
+    }
+
+    // value of a position after a move
+    double Expect(const GameState &state) {
+        const auto it = memo_.find(state);
+        if (it != memo_.end())
+            return it->second;
+        const uint32_t count = state.CountEmptyTiles();
+        double value = 0;
+        for (uint32_t i = 0; i < count; i++)
+            for (uint8_t power = 1; power <= 2; power++) {
+                GameState next(state);
+                next.GenerateTile(next.GetEmptyTile(i), power);
+                value += (power == 1 ? 0.9 : 0.1) * Best(next);
+            }
+        value = count > 0 ? value / count : 0;
+        memo_.emplace(state, value);
+        return value;
+    }
+
+ private:
+    Objective objective_;
+    std::unordered_map<GameState, double> memo_;
+};
+
+// the state of a key
+GameState Unpack(uint64_t key, uint32_t height, uint32_t width) {
+    GameState state(height, width);
+    for (uint32_t i = 0; i < height * width; i++)
+        if ((key >> 4 * i & 0xF) != 0)
+            state.GenerateTile(GameState::Position(i / width, i % width),
+                               key >> 4 * i & 0xF);
+    return state;
+}
+
+// check every value of a solver against the reference
+void Check(uint32_t height, uint32_t width, Objective objective) {
+    const Solver solver(height, width, objective);
+    ASSERT_EQ(solver.keys().size(), solver.values().size());
+    ASSERT_FALSE(solver.keys().empty());
+    EXPECT_TRUE(std::is_sorted(solver.keys().begin(), solver.keys().end()));
+    EXPECT_EQ(std::adjacent_find(solver.keys().begin(), solver.keys().end()),
+              solver.keys().end());
+
+    Reference reference(objective);
+    const TableKeys keys(height, width);
+    for (size_t i = 0; i < solver.keys().size(); i++) {
+        const uint64_t key = solver.keys()[i];
+        EXPECT_EQ(keys.Canonical(key), key);
+        EXPECT_NEAR(solver.values()[i],
+                    reference.Expect(Unpack(key, height, width)),
+                    1e-9 * (1 + solver.values()[i]));
+    }
+
+    // two random tiles on an empty board
+    const uint32_t tiles = height * width;
+    double start = 0;
+    for (uint32_t i = 0; i < tiles; i++)
+        for (uint8_t p = 1; p <= 2; p++)
+            for (uint32_t j = 0; j < tiles; j++)
+                for (uint8_t q = 1; q <= 2; q++) {
+                    if (j == i)
+                        continue;
+                    GameState state(height, width);
+                    state.GenerateTile(
+                            GameState::Position(i / width, i % width), p);
+                    state.GenerateTile(
+                            GameState::Position(j / width, j % width), q);
+                    start += (p == 1 ? 0.9 : 0.1) * (q == 1 ? 0.9 : 0.1) *
+                             reference.Best(state);
+                }
+    start /= tiles * (tiles - 1);
+    EXPECT_NEAR(solver.start_value(), start, 1e-9 * (1 + start));
+}
+
+TEST(SolverTest, Construct) {
+    EXPECT_THROW(Solver(0, 2, Objective::MOVES), std::invalid_argument);
+    EXPECT_THROW(Solver(1, 1, Objective::MOVES), std::invalid_argument);
+    EXPECT_THROW(Solver(2, 5, Objective::MOVES), std::invalid_argument);
+    const Solver solver(2, 2, Objective::SCORE);
+    EXPECT_EQ(solver.height(), 2u);
+    EXPECT_EQ(solver.width(), 2u);
+    EXPECT_EQ(solver.objective(), Objective::SCORE);
+}
+
+TEST(SolverTest, OneByTwo) {
+    // the two tiles only merge if both are 2s or both are 4s, and a merged
+    // tile only merges again with a new tile of its number
+    const Solver moves(1, 2, Objective::MOVES);
+    EXPECT_DOUBLE_EQ(moves.start_value(), 0.81 * (1 + 0.1) + 0.01);
+    const Solver score(1, 2, Objective::SCORE);
+    EXPECT_DOUBLE_EQ(score.start_value(), 0.81 * (4 + 0.1 * 8) + 0.01 * 8);
+}
+
+TEST(SolverTest, Reference) {
+    Check(2, 2, Objective::MOVES);
+    Check(2, 2, Objective::SCORE);
+    Check(1, 4, Objective::MOVES);
+    Check(3, 1, Objective::SCORE);
+    Check(2, 3, Objective::MOVES);
+}
+
+TEST(SolverTest, Write) {
+    const std::string path = testing::TempDir() + "solver_test.tbl";
+    const Solver solver(2, 3, Objective::SCORE);
+    solver.Write(path);
+    const ValueTable table(path);
+    EXPECT_EQ(table.height(), 2u);
+    EXPECT_EQ(table.width(), 3u);
+    EXPECT_EQ(table.objective(), Objective::SCORE);
+    ASSERT_EQ(table.size(), solver.keys().size());
+    for (size_t i = 0; i < solver.keys().size(); i += 97) {
+        double value;
+        ASSERT_TRUE(table.Find(solver.keys()[i], &value));
+        EXPECT_EQ(value, solver.values()[i]);
+    }
+}
+
+}  // namespace
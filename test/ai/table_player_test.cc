@@ -0,0 +1,140 @@
+#include "ai/table_player.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <stdexcept>
+
+#include "game_state.h"
+#include "symmetry.h"
+#include "ai/solver.h"
+
+namespace {
+
+using _2048::GameState;
+using _2048::Symmetry;
+using _2048::ai::Solver;
+using _2048::ai::TablePlayer;
+using Objective = Solver::Objective;
+
+class TablePlayerTest : public testing::Test {
+ protected:
+    // solve a board size, and write its table
+    static std::string Table(uint32_t height, uint32_t width,
+                             Objective objective) {
+        const std::string path = testing::TempDir() + "table_player_test_" +
+                                 std::to_string(height) + "x" +
+                                 std::to_string(width) +
+                                 (objective == Objective::MOVES ? "_moves" :
+                                                                  "_score") +
+                                 ".tbl";
+        Solver(height, width, objective).Write(path);
+        return path;
+    }
+
+    // play a game from two random tiles, checking that every move is legal
+    // return the number of moves, or the score
+    static uint64_t PlayGame(TablePlayer *player, uint32_t height,
+                             uint32_t width, std::mt19937_64 *engine) {
+        GameState state(height, width);
+        uint64_t moves = 0;
+        uint64_t score = 0;
+        for (uint32_t turn = 0; ; turn++) {
+            const uint32_t count = state.CountEmptyTiles();
+            if (count == 0)
+                break;
+            state.GenerateTile(state.GetEmptyTile((*engine)() % count),
+                               (*engine)() % 10 == 0 ? 2 : 1);
+            if (turn == 0)
+                continue;
+
+            GameState::Direction move = GameState::Direction::UP;
+            const GameState::DirectionMask mask = state.GetPossibleMoveMask();
+            const bool played = player->Play(state, &move);
+            EXPECT_EQ(played, mask != 0);
+            if (!played)
+                break;
+            EXPECT_TRUE(mask & GameState::ToMask(move));
+            EXPECT_GT(player->value(), 0);
+            score += state.Move(move).score;
+            moves++;
+        }
+        return player->table().objective() == Objective::MOVES ? moves :
+                                                                 score;
+    }
+};
+
+TEST_F(TablePlayerTest, Construct) {
+    EXPECT_THROW(TablePlayer(testing::TempDir() + "no_such_table.tbl"),
+                 std::runtime_error);
+    TablePlayer player(Table(2, 2, Objective::MOVES));
+    EXPECT_EQ(player.table().height(), 2u);
+    EXPECT_EQ(player.table().width(), 2u);
+    EXPECT_EQ(player.value(), 0);
+}
+
+TEST_F(TablePlayerTest, NoMove) {
+    // [[2, 4],
+    //  [8, 16]]
+    GameState state(2, 2);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(0, 1), 2);
+    state.GenerateTile(GameState::Position(1, 0), 3);
+    state.GenerateTile(GameState::Position(1, 1), 4);
+    TablePlayer player(Table(2, 2, Objective::MOVES));
+    GameState::Direction move = GameState::Direction::LEFT;
+    EXPECT_FALSE(player.Play(state, &move));
+    EXPECT_EQ(move, GameState::Direction::LEFT);
+    EXPECT_EQ(player.value(), 0);
+
+    EXPECT_THROW(player.Play(GameState(3, 3), &move), std::invalid_argument);
+    // no game on a 2 by 2 board gets to 1024
+    GameState unreachable(2, 2);
+    unreachable.GenerateTile(GameState::Position(0, 0), 10);
+    EXPECT_THROW(player.Play(unreachable, &move), std::out_of_range);
+}
+
+TEST_F(TablePlayerTest, Symmetric) {
+    // [[2, 4],
+    //  [_, 8]]
+    // every copy of a state is worth the same, and its best move is the
+    // copy of the best move of the state
+    GameState state(2, 2);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(0, 1), 2);
+    state.GenerateTile(GameState::Position(1, 1), 3);
+    TablePlayer player(Table(2, 2, Objective::SCORE));
+    GameState::Direction move;
+    ASSERT_TRUE(player.Play(state, &move));
+    const double value = player.value();
+    EXPECT_GT(value, 0);
+    for (uint8_t i = 0; i < Symmetry::kCount; i++) {
+        const Symmetry s(i);
+        GameState::Direction copy_move;
+        ASSERT_TRUE(player.Play(Transform(state, s), &copy_move));
+        EXPECT_EQ(player.value(), value);
+        EXPECT_EQ(copy_move, s.Apply(move));
+    }
+}
+
+TEST_F(TablePlayerTest, Games) {
+    // the mean of many games is close to the value of a new game
+    for (Objective objective : {Objective::MOVES, Objective::SCORE}) {
+        const Solver solver(2, 2, objective);
+        TablePlayer player(Table(2, 2, objective));
+        std::mt19937_64 engine(7);
+        const uint32_t games = 4000;
+        uint64_t total = 0;
+        for (uint32_t i = 0; i < games; i++)
+            total += PlayGame(&player, 2, 2, &engine);
+        EXPECT_NEAR(double(total) / games, solver.start_value(),
+                    0.05 * solver.start_value());
+    }
+    TablePlayer player(Table(2, 3, Objective::MOVES));
+    std::mt19937_64 engine(23);
+    for (uint32_t i = 0; i < 20; i++)
+        EXPECT_GT(PlayGame(&player, 2, 3, &engine), 0u);
+}
+
+}  // namespace
@@ -0,0 +1,116 @@
+#include "ai/thread_pool.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+using _2048::ai::ThreadPool;
+
+TEST(ThreadPoolTest, Size) {
+    EXPECT_EQ(ThreadPool(1).size(), 1u);
+    EXPECT_EQ(ThreadPool(3).size(), 3u);
+    EXPECT_EQ(ThreadPool(0).size(),
+              std::max(std::thread::hardware_concurrency(), 1u));
+}
+
+TEST(ThreadPoolTest, RunAll) {
+    ThreadPool pool(4);
+    for (uint32_t count : {0u, 1u, 3u, 1000u}) {
+        std::vector<std::atomic<uint32_t>> runs(count);
+        std::vector<uint32_t> threads(count);
+        pool.Run(count, [&](uint32_t thread, uint32_t task) {
+            runs[task]++;
+            threads[task] = thread;
+        });
+        for (uint32_t i = 0; i < count; i++) {
+            EXPECT_EQ(runs[i], 1u);
+            EXPECT_LT(threads[i], pool.size());
+        }
+    }
+}
+
+TEST(ThreadPoolTest, Parallel) {
+    // every thread takes a task when the tasks wait for each other
+    ThreadPool pool(4);
+    std::atomic<uint32_t> started(0);
+    std::set<uint32_t> threads;
+    std::mutex mutex;
+    pool.Run(4, [&](uint32_t thread, uint32_t task) {
+        started++;
+        while (started < 4)
+            std::this_thread::yield();
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(thread);
+    });
+    EXPECT_EQ(threads.size(), 4u);
+}
+
+TEST(ThreadPoolTest, Nested) {
+    // tasks split into tasks, of very different sizes
+    ThreadPool pool(4);
+    std::atomic<uint64_t> leaves(0);
+    std::function<void(uint32_t)> split = [&](uint32_t depth) {
+        if (depth == 0) {
+            leaves++;
+            return;
+        }
+        pool.Run(depth, [&](uint32_t thread, uint32_t task) {
+            EXPECT_EQ(pool.CurrentThread(), thread);
+            split(task);
+        });
+    };
+    split(10);
+    // a tree where a node of depth d has children of depth 0 to d - 1 has
+    // 2^(d - 1) leaves
+    EXPECT_EQ(leaves, 512u);
+    EXPECT_EQ(pool.CurrentThread(), 0u);
+}
+
+TEST(ThreadPoolTest, Shared) {
+    // callers outside the pool take turns
+    ThreadPool pool(3);
+    std::atomic<uint32_t> runs(0);
+    std::vector<std::thread> callers;
+    for (uint32_t i = 0; i < 4; i++)
+        callers.emplace_back([&] {
+            for (uint32_t n = 0; n < 50; n++)
+                pool.Run(20, [&](uint32_t thread, uint32_t task) {
+                    pool.Run(2, [&](uint32_t, uint32_t) { runs++; });
+                });
+        });
+    for (std::thread &caller : callers)
+        caller.join();
+    EXPECT_EQ(runs, 4u * 50 * 20 * 2);
+}
+
+TEST(ThreadPoolTest, Exception) {
+    ThreadPool pool(3);
+    EXPECT_THROW(pool.Run(100, [](uint32_t thread, uint32_t task) {
+                     if (task == 10)
+                         throw std::runtime_error("task failed");
+                 }),
+                 std::runtime_error);
+    // the pool still works
+    std::atomic<uint32_t> runs(0);
+    pool.Run(10, [&](uint32_t thread, uint32_t task) { runs++; });
+    EXPECT_EQ(runs, 10u);
+    // an exception of a nested task reaches the outermost caller
+    EXPECT_THROW(pool.Run(4, [&](uint32_t thread, uint32_t task) {
+                     pool.Run(4, [](uint32_t thread, uint32_t task) {
+                         if (task == 3)
+                             throw std::runtime_error("task failed");
+                     });
+                 }),
+                 std::runtime_error);
+}
+
+}  // namespace
@@ -0,0 +1,107 @@
+#include "ai/transposition_table.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+
+namespace {
+
+using Table = _2048::ai::TranspositionTable<int64_t>;
+using Bound = Table::Bound;
+
+// keys that share the only bucket of a 0 MB table
+constexpr uint64_t Key(uint32_t n) { return uint64_t(n + 1) << 32; }
+
+TEST(TranspositionTableTest, Size) {
+    Table tiny(0);
+    EXPECT_EQ(tiny.capacity(), 4u);
+    EXPECT_EQ(tiny.bytes(), 64u);
+    Table table(3);
+    EXPECT_EQ(table.bytes(), 2u * 1024 * 1024);
+    EXPECT_EQ(table.capacity(), table.bytes() / 16);
+}
+
+TEST(TranspositionTableTest, ProbeStore) {
+    Table table(1);
+    Table::Entry entry;
+    EXPECT_FALSE(table.Probe(12345, &entry));
+    table.Store(12345, Table::Entry{-7, 3, Bound::LOWER, 2});
+    ASSERT_TRUE(table.Probe(12345, &entry));
+    EXPECT_EQ(entry.value, -7);
+    EXPECT_EQ(entry.depth, 3);
+    EXPECT_EQ(entry.bound, Bound::LOWER);
+    EXPECT_EQ(entry.move, 2);
+    EXPECT_FALSE(table.Probe(12345 + Key(0), &entry));
+
+    EXPECT_EQ(table.stats().hits, 1u);
+    EXPECT_EQ(table.stats().misses, 2u);
+    EXPECT_EQ(table.stats().stores, 1u);
+    EXPECT_EQ(table.stats().collisions, 0u);
+    EXPECT_EQ(table.stats().reused, 0u);
+
+    // entries of an earlier search are still found, and counted as reused
+    table.NewSearch();
+    ASSERT_TRUE(table.Probe(12345, &entry));
+    EXPECT_EQ(entry.value, -7);
+    EXPECT_EQ(table.stats().reused, 1u);
+    table.ResetStats();
+    EXPECT_EQ(table.stats().misses, 0u);
+
+    table.Clear();
+    EXPECT_FALSE(table.Probe(12345, &entry));
+}
+
+TEST(TranspositionTableTest, DepthPreferred) {
+    Table table(0);
+    Table::Entry entry;
+    for (uint32_t i = 0; i < 4; i++)
+        table.Store(Key(i), Table::Entry{i, uint8_t(4 - i), Bound::EXACT, 0});
+
+    // a shallower result does not replace a deeper one of the same search
+    table.Store(Key(0), Table::Entry{100, 1, Bound::EXACT, 0});
+    ASSERT_TRUE(table.Probe(Key(0), &entry));
+    EXPECT_EQ(entry.value, 0);
+    table.Store(Key(0), Table::Entry{100, 4, Bound::EXACT, 0});
+    ASSERT_TRUE(table.Probe(Key(0), &entry));
+    EXPECT_EQ(entry.value, 100);
+
+    // a new position replaces the shallowest one
+    table.Store(Key(4), Table::Entry{4, 2, Bound::EXACT, 0});
+    EXPECT_EQ(table.stats().collisions, 1u);
+    EXPECT_FALSE(table.Probe(Key(3), &entry));
+    for (uint32_t i : {0, 1, 2, 4})
+        EXPECT_TRUE(table.Probe(Key(i), &entry));
+
+    // entries of an earlier search go first, however deep
+    table.NewSearch();
+    table.Store(Key(2), Table::Entry{2, 1, Bound::EXACT, 0});
+    table.Store(Key(5), Table::Entry{5, 1, Bound::EXACT, 0});
+    EXPECT_EQ(table.stats().collisions, 1u);
+    EXPECT_FALSE(table.Probe(Key(4), &entry));
+    for (uint32_t i : {0, 1, 2, 5})
+        EXPECT_TRUE(table.Probe(Key(i), &entry));
+    ASSERT_TRUE(table.Probe(Key(2), &entry));
+    EXPECT_EQ(entry.depth, 1);
+}
+
+TEST(TranspositionTableTest, ManySearches) {
+    // an entry stays older than the current search however many searches
+    // have passed
+    Table table(0);
+    Table::Entry entry;
+    table.Store(Key(0), Table::Entry{0, 9, Bound::EXACT, 0});
+    for (uint32_t i = 0; i < 1000; i++) {
+        table.NewSearch();
+        table.ResetStats();
+        ASSERT_TRUE(table.Probe(Key(0), &entry));
+        ASSERT_EQ(table.stats().reused, 1u) << "after " << i + 1
+                                            << " searches";
+    }
+
+    // so it is replaced before the shallower entries of the current search
+    for (uint32_t i = 1; i < 5; i++)
+        table.Store(Key(i), Table::Entry{i, 1, Bound::EXACT, 0});
+    EXPECT_FALSE(table.Probe(Key(0), &entry));
+    EXPECT_EQ(table.stats().collisions, 0u);
+}
+
+}  // namespace
@@ -0,0 +1,137 @@
+#include "ai/value_table.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "game_state.h"
+#include "symmetry.h"
+
+namespace {
+
+using _2048::GameState;
+using _2048::Symmetry;
+using _2048::ai::TableKeys;
+using _2048::ai::ValueTable;
+
+TEST(TableKeysTest, Construct) {
+    EXPECT_THROW(TableKeys(0, 3), std::invalid_argument);
+    EXPECT_THROW(TableKeys(3, 0), std::invalid_argument);
+    EXPECT_THROW(TableKeys(4, 5), std::invalid_argument);
+    EXPECT_NO_THROW(TableKeys(4, 4));
+    EXPECT_NO_THROW(TableKeys(1, 16));
+}
+
+TEST(TableKeysTest, Pack) {
+    // [[2, _, 8],
+    //  [_, 4, _]]
+    GameState state(2, 3);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(0, 2), 3);
+    state.GenerateTile(GameState::Position(1, 1), 2);
+    TableKeys keys(2, 3);
+    EXPECT_EQ(keys.Pack(state), 0x020301u);
+    EXPECT_THROW(keys.Pack(GameState(3, 2)), std::invalid_argument);
+    GameState big(2, 3);
+    big.GenerateTile(GameState::Position(0, 0), 16);
+    EXPECT_THROW(keys.Pack(big), std::invalid_argument);
+}
+
+TEST(TableKeysTest, Canonical) {
+    // the 8 copies of a square state have one canonical key
+    // [[2, 4, _],
+    //  [_, _, _],
+    //  [8, _, _]]
+    GameState state(3, 3);
+    state.GenerateTile(GameState::Position(0, 0), 1);
+    state.GenerateTile(GameState::Position(0, 1), 2);
+    state.GenerateTile(GameState::Position(2, 0), 3);
+    TableKeys keys(3, 3);
+    const uint64_t canonical = keys.Canonical(keys.Pack(state));
+    for (uint8_t i = 0; i < Symmetry::kCount; i++) {
+        const uint64_t key = keys.Pack(Transform(state, Symmetry(i)));
+        EXPECT_EQ(keys.Canonical(key), canonical);
+        EXPECT_LE(canonical, key);
+    }
+
+    // the 4 reflections of a rectangular state, and not its transpose
+    // [[2, 4, _],
+    //  [_, _, 8]]
+    GameState rect(2, 3);
+    rect.GenerateTile(GameState::Position(0, 0), 1);
+    rect.GenerateTile(GameState::Position(0, 1), 2);
+    rect.GenerateTile(GameState::Position(1, 2), 3);
+    GameState flipped(2, 3);
+    flipped.GenerateTile(GameState::Position(1, 2), 1);
+    flipped.GenerateTile(GameState::Position(1, 1), 2);
+    flipped.GenerateTile(GameState::Position(0, 0), 3);
+    TableKeys rect_keys(2, 3);
+    EXPECT_EQ(rect_keys.Canonical(rect_keys.Pack(rect)),
+              rect_keys.Canonical(rect_keys.Pack(flipped)));
+    EXPECT_EQ(TableKeys(1, 3).Canonical(0x123), 0x123u);
+    EXPECT_EQ(TableKeys(1, 3).Canonical(0x321), 0x123u);
+}
+
+TEST(ValueTableTest, WriteFind) {
+    const std::string path = testing::TempDir() + "value_table_test.tbl";
+    const std::vector<uint64_t> keys{1, 5, 0x20, 0x123456789};
+    const std::vector<double> values{0.5, 2, -1, 1e9};
+    ValueTable::Write(path, 3, 3, ValueTable::Objective::SCORE, keys, values);
+
+    ValueTable table(path);
+    EXPECT_EQ(table.height(), 3u);
+    EXPECT_EQ(table.width(), 3u);
+    EXPECT_EQ(table.objective(), ValueTable::Objective::SCORE);
+    EXPECT_EQ(table.size(), 4u);
+    for (size_t i = 0; i < keys.size(); i++) {
+        double value;
+        ASSERT_TRUE(table.Find(keys[i], &value));
+        EXPECT_EQ(value, values[i]);
+    }
+    EXPECT_FALSE(table.Find(0, nullptr));
+    EXPECT_FALSE(table.Find(6, nullptr));
+    EXPECT_FALSE(table.Find(~uint64_t(0), nullptr));
+
+    ValueTable::Write(path, 1, 2, ValueTable::Objective::MOVES, {}, {});
+    ValueTable empty(path);
+    EXPECT_EQ(empty.size(), 0u);
+    EXPECT_EQ(empty.objective(), ValueTable::Objective::MOVES);
+    EXPECT_FALSE(empty.Find(1, nullptr));
+}
+
+TEST(ValueTableTest, Invalid) {
+    const std::string path = testing::TempDir() + "value_table_test.tbl";
+    EXPECT_THROW(ValueTable::Write(path, 3, 3, ValueTable::Objective::MOVES,
+                                   {1, 2}, {0}),
+                 std::invalid_argument);
+    EXPECT_THROW(ValueTable::Write(path, 3, 3, ValueTable::Objective::MOVES,
+                                   {2, 2}, {0, 0}),
+                 std::invalid_argument);
+    EXPECT_THROW(ValueTable::Write(path, 5, 5, ValueTable::Objective::MOVES,
+                                   {}, {}),
+                 std::invalid_argument);
+
+    EXPECT_THROW(ValueTable(testing::TempDir() + "no_such_table.tbl"),
+                 std::runtime_error);
+    std::ofstream(path) << "not a value table, but long enough to have a "
+                           "header";
+    EXPECT_THROW(ValueTable table(path), std::runtime_error);
+
+    // a table cut short
+    ValueTable::Write(path, 2, 2, ValueTable::Objective::MOVES, {1, 2},
+                      {0, 0});
+    std::string data;
+    {
+        std::ifstream in(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+    }
+    std::ofstream(path, std::ios::binary) << data.substr(0, data.size() - 8);
+    EXPECT_THROW(ValueTable table(path), std::runtime_error);
+}
+
+}  // namespace
@@ -0,0 +1,208 @@
+#include "bit_board_4x4.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+#include "game_state.h"
+
+namespace {
+
+using _2048::BitBoard4x4;
+using _2048::GameState;
+
+class BitBoard4x4Test : public testing::Test {
+ protected:
+    BitBoard4x4 b1_;
+    BitBoard4x4 b2_;
+
+    void SetUp() override {
+        // [[2,    4,  8,  16],
+        //  [32,   64, 2,  4 ],
+        //  [8,    16, 32, 64],
+        //  [2,    4,  8,  16]]
+        uint8_t powers[] = {1, 2, 3, 4, 5, 6, 1, 2, 3, 4, 5, 6, 1, 2, 3, 4};
+        for (uint32_t i = 0; i < 16; i++)
+            b1_.GenerateTile(BitBoard4x4::Position(i / 4, i % 4), powers[i]);
+        // [[_,    2,  _,  4],
+        //  [_,    2,  _,  _],
+        //  [8,    4,  4,  _],
+        //  [2048, 64, 32, _]]
+        b2_.GenerateTile(BitBoard4x4::Position(0, 1), 1);
+        b2_.GenerateTile(BitBoard4x4::Position(0, 3), 2);
+        b2_.GenerateTile(BitBoard4x4::Position(1, 1), 1);
+        b2_.GenerateTile(BitBoard4x4::Position(2, 0), 3);
+        b2_.GenerateTile(BitBoard4x4::Position(2, 1), 2);
+        b2_.GenerateTile(BitBoard4x4::Position(2, 2), 2);
+        b2_.GenerateTile(BitBoard4x4::Position(3, 0), 11);
+        b2_.GenerateTile(BitBoard4x4::Position(3, 1), 6);
+        b2_.GenerateTile(BitBoard4x4::Position(3, 2), 5);
+    }
+};
+
+TEST_F(BitBoard4x4Test, ConvertGameState) {
+    GameState s2 = b2_.ToGameState();
+    EXPECT_EQ(BitBoard4x4(s2), b2_);
+    EXPECT_THROW(BitBoard4x4(GameState(4, 5)), std::invalid_argument);
+    GameState big(4, 4);
+    big.GenerateTile(GameState::Position(1, 2), 16);
+    EXPECT_THROW((BitBoard4x4(big)), std::invalid_argument);
+}
+
+TEST_F(BitBoard4x4Test, Hash) {
+    EXPECT_NE(b1_.Hash(), b2_.Hash());
+    EXPECT_EQ(BitBoard4x4(b2_.raw()).Hash(), b2_.Hash());
+    EXPECT_EQ(std::hash<BitBoard4x4>()(b2_), b2_.Hash());
+}
+
+TEST_F(BitBoard4x4Test, Tile) {
+    EXPECT_THROW(b1_.tile(BitBoard4x4::Position(4, 0)), std::out_of_range);
+    EXPECT_EQ(b2_.tile(BitBoard4x4::Position(3, 0)).power(), 11);
+    EXPECT_TRUE(b2_.tile(BitBoard4x4::Position(0, 0)).empty());
+}
+
+TEST_F(BitBoard4x4Test, GetEmptyTiles) {
+    auto e1 = b1_.GetEmptyTiles();
+    auto e2 = b2_.GetEmptyTiles();
+
+    EXPECT_EQ(e1, decltype(e1)({}));
+    EXPECT_EQ(e2, b2_.ToGameState().GetEmptyTiles());
+}
+
+TEST_F(BitBoard4x4Test, GetEmptyTile) {
+    EXPECT_EQ(b1_.CountEmptyTiles(), 0u);
+    EXPECT_THROW(b1_.GetEmptyTile(0), std::out_of_range);
+    auto e2 = b2_.GetEmptyTiles();
+    EXPECT_EQ(b2_.CountEmptyTiles(), e2.size());
+    for (uint32_t i = 0; i < e2.size(); i++)
+        EXPECT_EQ(b2_.GetEmptyTile(i), e2[i]);
+    EXPECT_THROW(b2_.GetEmptyTile(e2.size()), std::out_of_range);
+}
+
+TEST_F(BitBoard4x4Test, GenerateTile) {
+    EXPECT_THROW(b1_.GenerateTile(BitBoard4x4::Position(2, 4), 1),
+                 std::out_of_range);
+    EXPECT_FALSE(b1_.GenerateTile(BitBoard4x4::Position(0, 0), 1));
+    EXPECT_THROW(b2_.GenerateTile(BitBoard4x4::Position(0, 2), 16),
+                 std::invalid_argument);
+    EXPECT_TRUE(b2_.GenerateTile(BitBoard4x4::Position(0, 2), 11));
+    EXPECT_EQ(b2_.tile(BitBoard4x4::Position(0, 2)).power(), 11);
+}
+
+TEST_F(BitBoard4x4Test, GetPossibleMoves) {
+    EXPECT_EQ(b1_.GetPossibleMoveMask(), 0);
+    EXPECT_EQ(b2_.GetPossibleMoveMask(),
+              b2_.ToGameState().GetPossibleMoveMask());
+    auto m1 = b1_.GetPossibleMoves();
+    auto m2 = b2_.GetPossibleMoves();
+    EXPECT_EQ(m1, decltype(m1)({}));
+    EXPECT_EQ(m2, b2_.ToGameState().GetPossibleMoves());
+}
+
+TEST_F(BitBoard4x4Test, Move) {
+    for (auto dir : {GameState::Direction::LEFT, GameState::Direction::RIGHT,
+                     GameState::Direction::UP, GameState::Direction::DOWN}) {
+        BitBoard4x4 b1(b1_);
+        EXPECT_FALSE(b1.Move(dir));
+        EXPECT_EQ(b1, b1_);
+
+        BitBoard4x4 b2(b2_);
+        GameState s2 = b2_.ToGameState();
+        GameState::MoveResult result = s2.Move(dir);
+        GameState::MoveResult b2_result = b2.Move(dir);
+        EXPECT_TRUE(result.moved);
+        EXPECT_EQ(b2_result.moved, result.moved);
+        EXPECT_EQ(b2_result.score, result.score);
+        EXPECT_EQ(b2_result.merges, result.merges);
+        EXPECT_EQ(b2.ToGameState(), s2);
+    }
+}
+
+TEST_F(BitBoard4x4Test, EveryRow) {
+    // every packed row moves as in GameState, as a row and as a col, except
+    // rows with a tile of 4096 or more, which may saturate
+    for (uint32_t row = 0; row < (1 << 16); row++) {
+        if (((row & 0x7777) << 1 & row & 0x8888) != 0)
+            continue;
+        BitBoard4x4 board;
+        GameState state(4, 4);
+        for (uint32_t c = 0; c < 4; c++) {
+            const uint8_t power = row >> (4 * c) & 0xF;
+            if (power == 0)
+                continue;
+            const GameState::Position pos = row % 2 == 0 ?
+                                            GameState::Position(1, c) :
+                                            GameState::Position(c, 2);
+            board.GenerateTile(pos, power);
+            state.GenerateTile(pos, power);
+        }
+        for (auto dir : GameState::kDirections) {
+            BitBoard4x4 moved(board);
+            GameState expected_state(state);
+            GameState::MoveResult expected = expected_state.Move(dir);
+            GameState::MoveResult actual = moved.Move(dir);
+            ASSERT_EQ(actual.moved, expected.moved) << row;
+            ASSERT_EQ(actual.score, expected.score) << row;
+            ASSERT_EQ(actual.merges, expected.merges) << row;
+            ASSERT_EQ(moved.ToGameState(), expected_state) << row;
+        }
+    }
+}
+
+TEST_F(BitBoard4x4Test, Undo) {
+    BitBoard4x4 ans(b2_);
+    BitBoard4x4::UndoRecord undo;
+    b2_.Undo(undo);
+    EXPECT_EQ(b2_, ans);
+    for (auto dir : GameState::kDirections) {
+        EXPECT_TRUE(b2_.Move(dir, &undo));
+        b2_.Undo(undo);
+        EXPECT_EQ(b2_, ans);
+    }
+    EXPECT_TRUE(b2_.GenerateTile(BitBoard4x4::Position(0, 0), 1, &undo));
+    b2_.Undo(undo);
+    EXPECT_EQ(b2_, ans);
+}
+
+TEST_F(BitBoard4x4Test, RandomGames) {
+    std::mt19937_64 engine(2048);
+    for (uint32_t game = 0; game < 20; game++) {
+        BitBoard4x4 board;
+        GameState state(4, 4);
+        while (true) {
+            auto empties = state.GetEmptyTiles();
+            ASSERT_EQ(board.GetEmptyTiles(), empties);
+            if (empties.empty())
+                break;
+            auto pos = empties[engine() % empties.size()];
+            uint8_t power = engine() % 10 == 0 ? 2 : 1;
+            ASSERT_TRUE(board.GenerateTile(pos, power));
+            ASSERT_TRUE(state.GenerateTile(pos, power));
+
+            auto moves = state.GetPossibleMoves();
+            ASSERT_EQ(board.GetPossibleMoves(), moves);
+            if (moves.empty())
+                break;
+            auto dir = moves[engine() % moves.size()];
+            GameState::MoveResult expected = state.Move(dir);
+            GameState::MoveResult actual = board.Move(dir);
+            ASSERT_TRUE(expected.moved);
+            ASSERT_EQ(actual.moved, expected.moved);
+            ASSERT_EQ(actual.score, expected.score);
+            ASSERT_EQ(actual.merges, expected.merges);
+            ASSERT_EQ(board.ToGameState(), state);
+        }
+    }
+}
+
+TEST_F(BitBoard4x4Test, Print) {
+    std::ostringstream oss1, oss2;
+    oss1 << b2_;
+    oss2 << b2_.ToGameState();
+    EXPECT_EQ(oss1.str(), "[[,2,,4],[,2,,],[8,4,4,],[2048,64,32,]]");
+    EXPECT_EQ(oss1.str(), oss2.str());
+}
+
+}  // namespace
@@ -1,9 +1,14 @@
 #include "game_state.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
 #include <memory>
+#include <random>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_set>
+#include <vector>
 
 #include "tile.h"
 
@@ -43,6 +48,35 @@ class GameStateTest : public testing::Test {
     }
 };
 
+// check the incrementally maintained statistics against a full scan
+void ExpectStats(const GameState &state) {
+    uint32_t num_tiles = 0;
+    uint8_t max_power = 0;
+    uint64_t power_sum = 0;
+    GameState rebuilt(state.height(), state.width());
+    std::vector<uint64_t> bitmap(
+            (state.height() * state.width() + 63) / 64, 0);
+    for (uint32_t r = 0; r < state.height(); r++)
+        for (uint32_t c = 0; c < state.width(); c++) {
+            const _2048::Tile &tile = state.tile(GameState::Position(r, c));
+            const uint32_t i = r * state.width() + c;
+            if (tile.empty())
+                bitmap[i / 64] |= 1ull << (i % 64);
+            else
+                num_tiles++;
+            max_power = std::max(max_power, tile.power());
+            rebuilt.GenerateTile(GameState::Position(r, c), tile.power());
+            power_sum += tile.power();
+        }
+    EXPECT_EQ(state.CountTiles(), num_tiles);
+    EXPECT_EQ(state.CountEmptyTiles(),
+              state.height() * state.width() - num_tiles);
+    EXPECT_EQ(state.GetMaxPower(), max_power);
+    EXPECT_EQ(state.GetPowerSum(), power_sum);
+    EXPECT_EQ(state.GetEmptyBitmap(), bitmap);
+    EXPECT_EQ(state.Hash(), rebuilt.Hash());
+}
+
 TEST_F(GameStateTest, CopyMoveConstruct) {
     GameState g1(*g1_);
     GameState g2(*g2_);
@@ -60,6 +94,17 @@ TEST_F(GameStateTest, CopyMoveConstruct) {
     EXPECT_THROW(g2 == *g2_, std::runtime_error);
 }
 
+TEST_F(GameStateTest, Assign) {
+    GameState g2(4, 4);
+    g2 = *g2_;
+    EXPECT_EQ(g2, *g2_);
+    EXPECT_THROW(g2 = *g1_, std::invalid_argument);
+
+    GameState moved(std::move(g2));
+    g2 = *g2_;
+    EXPECT_EQ(g2, *g2_);
+}
+
 TEST_F(GameStateTest, InvalidState) {
     GameState g(std::move(*g1_));
 
@@ -70,10 +115,61 @@ TEST_F(GameStateTest, InvalidState) {
     EXPECT_THROW(*g1_ != g, std::runtime_error);
     EXPECT_THROW(g1_->tile(GameState::Position(0, 0)), std::runtime_error);
     EXPECT_THROW(g1_->GetEmptyTiles(), std::runtime_error);
+    EXPECT_THROW(g1_->CountEmptyTiles(), std::runtime_error);
+    EXPECT_THROW(g1_->GetEmptyTile(0), std::runtime_error);
+    EXPECT_THROW(g1_->GetEmptyBitmap(), std::runtime_error);
+    EXPECT_THROW(g1_->CountTiles(), std::runtime_error);
+    EXPECT_THROW(g1_->GetMaxPower(), std::runtime_error);
+    EXPECT_THROW(g1_->GetPowerSum(), std::runtime_error);
+    EXPECT_THROW(g1_->Hash(), std::runtime_error);
     EXPECT_THROW(g1_->GenerateTile(GameState::Position(0, 0), 1),
                  std::runtime_error);
     EXPECT_THROW(g1_->GetPossibleMoves(), std::runtime_error);
+    EXPECT_THROW(g1_->GetPossibleMoveMask(), std::runtime_error);
     EXPECT_THROW(g1_->Move(GameState::Direction::LEFT), std::runtime_error);
+    GameState::UndoRecord undo;
+    EXPECT_THROW(g1_->Move(GameState::Direction::LEFT, &undo),
+                 std::runtime_error);
+    EXPECT_THROW(g1_->Undo(undo), std::runtime_error);
+}
+
+TEST_F(GameStateTest, Stats) {
+    EXPECT_EQ(g1_->CountTiles(), 4u);
+    EXPECT_EQ(g1_->GetMaxPower(), 4);
+    EXPECT_EQ(g1_->GetPowerSum(), 10u);
+    EXPECT_EQ(g2_->CountTiles(), 9u);
+    EXPECT_EQ(g2_->GetMaxPower(), 11);
+    EXPECT_EQ(g2_->GetPowerSum(), 33u);
+    EXPECT_EQ(g2_->GetEmptyBitmap(), std::vector<uint64_t>({0x88D5}));
+    ExpectStats(*g1_);
+    ExpectStats(*g2_);
+    ExpectStats(GameState(1, 70));
+
+    for (auto dir : GameState::kDirections) {
+        GameState g2(*g2_);
+        g2.Move(dir);
+        ExpectStats(g2);
+        EXPECT_EQ(g2.CountTiles(), 8u);
+    }
+}
+
+TEST_F(GameStateTest, Hash) {
+    EXPECT_EQ(GameState(4, 4).Hash(), 0u);
+    EXPECT_NE(g1_->Hash(), g2_->Hash());
+    EXPECT_EQ(GameState(*g2_).Hash(), g2_->Hash());
+    EXPECT_EQ(std::hash<GameState>()(*g2_), g2_->Hash());
+
+    std::unordered_set<GameState> states;
+    states.insert(*g2_);
+    for (auto dir : GameState::kDirections) {
+        GameState g2(*g2_);
+        g2.Move(dir);
+        EXPECT_NE(g2.Hash(), g2_->Hash());
+        states.insert(g2);
+        states.insert(g2);
+    }
+    EXPECT_EQ(states.size(), 5u);
+    EXPECT_EQ(states.count(*g2_), 1u);
 }
 
 TEST_F(GameStateTest, GetEmptyTiles) {
@@ -92,6 +188,19 @@ TEST_F(GameStateTest, GetEmptyTiles) {
         }));
 }
 
+TEST_F(GameStateTest, CountEmptyTiles) {
+    EXPECT_EQ(g1_->CountEmptyTiles(), 0u);
+    EXPECT_EQ(g2_->CountEmptyTiles(), 7u);
+}
+
+TEST_F(GameStateTest, GetEmptyTile) {
+    EXPECT_THROW(g1_->GetEmptyTile(0), std::out_of_range);
+    auto e2 = g2_->GetEmptyTiles();
+    for (uint32_t i = 0; i < e2.size(); i++)
+        EXPECT_EQ(g2_->GetEmptyTile(i), e2[i]);
+    EXPECT_THROW(g2_->GetEmptyTile(e2.size()), std::out_of_range);
+}
+
 TEST_F(GameStateTest, GenerateTile) {
     EXPECT_THROW(g1_->GenerateTile(GameState::Position(2, 2), 1),
                  std::out_of_range);
@@ -114,6 +223,19 @@ TEST_F(GameStateTest, GetPossibleMoves) {
         }));
 }
 
+TEST_F(GameStateTest, GetPossibleMoveMask) {
+    EXPECT_EQ(g1_->GetPossibleMoveMask(), 0);
+    EXPECT_EQ(g2_->GetPossibleMoveMask(), 0xF);
+
+    // [[2, _],
+    //  [4, _]]
+    GameState g(2, 2);
+    g.GenerateTile(GameState::Position(0, 0), 1);
+    g.GenerateTile(GameState::Position(1, 0), 2);
+    EXPECT_EQ(g.GetPossibleMoveMask(),
+              GameState::ToMask(GameState::Direction::RIGHT));
+}
+
 TEST_F(GameStateTest, MoveLeft) {
     GameState ans1(*g1_);
     EXPECT_FALSE(g1_->Move(GameState::Direction::LEFT));
@@ -132,7 +254,10 @@ TEST_F(GameStateTest, MoveLeft) {
     ans2.GenerateTile(GameState::Position(3, 0), 11);
     ans2.GenerateTile(GameState::Position(3, 1), 6);
     ans2.GenerateTile(GameState::Position(3, 2), 5);
-    EXPECT_TRUE(g2_->Move(GameState::Direction::LEFT));
+    GameState::MoveResult result = g2_->Move(GameState::Direction::LEFT);
+    EXPECT_TRUE(result.moved);
+    EXPECT_EQ(result.score, 8u);
+    EXPECT_EQ(result.merges, 1u);
     EXPECT_EQ(*g2_, ans2);
 }
 
@@ -154,7 +279,10 @@ TEST_F(GameStateTest, MoveRight) {
     ans2.GenerateTile(GameState::Position(3, 1), 11);
     ans2.GenerateTile(GameState::Position(3, 2), 6);
     ans2.GenerateTile(GameState::Position(3, 3), 5);
-    EXPECT_TRUE(g2_->Move(GameState::Direction::RIGHT));
+    GameState::MoveResult result = g2_->Move(GameState::Direction::RIGHT);
+    EXPECT_TRUE(result.moved);
+    EXPECT_EQ(result.score, 8u);
+    EXPECT_EQ(result.merges, 1u);
     EXPECT_EQ(*g2_, ans2);
 }
 
@@ -176,7 +304,10 @@ TEST_F(GameStateTest, MoveUp) {
     ans2.GenerateTile(GameState::Position(1, 1), 2);
     ans2.GenerateTile(GameState::Position(1, 2), 5);
     ans2.GenerateTile(GameState::Position(2, 1), 6);
-    EXPECT_TRUE(g2_->Move(GameState::Direction::UP));
+    GameState::MoveResult result = g2_->Move(GameState::Direction::UP);
+    EXPECT_TRUE(result.moved);
+    EXPECT_EQ(result.score, 4u);
+    EXPECT_EQ(result.merges, 1u);
     EXPECT_EQ(*g2_, ans2);
 }
 
@@ -198,10 +329,72 @@ TEST_F(GameStateTest, MoveDown) {
     ans2.GenerateTile(GameState::Position(3, 1), 6);
     ans2.GenerateTile(GameState::Position(3, 2), 5);
     ans2.GenerateTile(GameState::Position(3, 3), 2);
-    EXPECT_TRUE(g2_->Move(GameState::Direction::DOWN));
+    GameState::MoveResult result = g2_->Move(GameState::Direction::DOWN);
+    EXPECT_TRUE(result.moved);
+    EXPECT_EQ(result.score, 4u);
+    EXPECT_EQ(result.merges, 1u);
     EXPECT_EQ(*g2_, ans2);
 }
 
+TEST_F(GameStateTest, UndoTile) {
+    GameState ans2(*g2_);
+    GameState::UndoRecord undo;
+    EXPECT_TRUE(g2_->GenerateTile(GameState::Position(0, 0), 3, &undo));
+    EXPECT_NE(*g2_, ans2);
+    g2_->Undo(undo);
+    EXPECT_EQ(*g2_, ans2);
+
+    EXPECT_FALSE(g2_->GenerateTile(GameState::Position(0, 1), 3, &undo));
+    g2_->Undo(undo);
+    EXPECT_EQ(*g2_, ans2);
+}
+
+TEST_F(GameStateTest, UndoMove) {
+    for (auto dir : GameState::kDirections) {
+        GameState ans1(*g1_);
+        GameState ans2(*g2_);
+        GameState::UndoRecord undo;
+        EXPECT_FALSE(g1_->Move(dir, &undo));
+        g1_->Undo(undo);
+        EXPECT_EQ(*g1_, ans1);
+        EXPECT_TRUE(g2_->Move(dir, &undo));
+        g2_->Undo(undo);
+        EXPECT_EQ(*g2_, ans2);
+
+        GameState::UndoRecord undo1;
+        g1_->Move(dir, &undo1);
+        EXPECT_THROW(g2_->Undo(undo1), std::logic_error);
+    }
+}
+
+TEST_F(GameStateTest, UndoRandomGames) {
+    std::mt19937_64 engine(6);
+    for (auto size : {std::make_pair(4u, 4u), std::make_pair(3u, 5u),
+                      std::make_pair(10u, 10u), std::make_pair(1u, 70u)}) {
+        GameState state(size.first, size.second);
+        std::vector<GameState> history;
+        std::vector<GameState::UndoRecord> undos(200);
+        for (auto &undo : undos) {
+            history.push_back(state);
+            if (engine() % 2 == 0 && state.CountEmptyTiles() != 0) {
+                auto pos = state.GetEmptyTile(
+                        engine() % state.CountEmptyTiles());
+                ASSERT_TRUE(state.GenerateTile(pos, engine() % 3 + 1, &undo));
+            } else {
+                state.Move(GameState::kDirections[engine() % 4], &undo);
+            }
+            ExpectStats(state);
+        }
+        while (!undos.empty()) {
+            state.Undo(undos.back());
+            ASSERT_EQ(state, history.back());
+            ExpectStats(state);
+            undos.pop_back();
+            history.pop_back();
+        }
+    }
+}
+
 TEST_F(GameStateTest, Print) {
     {
         std::ostringstream oss;
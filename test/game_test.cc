@@ -42,6 +42,18 @@ class DummyPlayer : public _2048::Player {
     }
 };
 
+class LimitedPlayer : public DummyPlayer {
+ public:
+    using DummyPlayer::Play;
+    bool Play(const GameState &state, GameState::Direction *move,
+              const _2048::SearchLimits &limits) override {
+        depth_ = limits.depth;
+        return Play(state, move);
+    }
+
+    uint32_t depth_ = 0;
+};
+
 class GameTest : public testing::Test {
  protected:
     Game g1_;
@@ -170,6 +182,8 @@ TEST_F(GameTest, Generate) {
 TEST_F(GameTest, Play) {
     EXPECT_FALSE(g1_.Play());
     EXPECT_TRUE(g2_.Play());
+    EXPECT_EQ(g1_.GetScore(), 0u);
+    EXPECT_EQ(g2_.GetScore(), 8u);
 
     // 2x2
     // [[2, 4 ],
@@ -201,4 +215,20 @@ TEST_F(GameTest, Play) {
     EXPECT_EQ(*view2_.state_, s2);
 }
 
+TEST_F(GameTest, PlayWithLimits) {
+    _2048::SearchLimits limits;
+    limits.depth = 3;
+    // a player that does not search ignores the limits
+    EXPECT_TRUE(g2_.Play(limits));
+    EXPECT_EQ(g2_.GetScore(), 8u);
+
+    // the game passes the limits on, and no limits without them
+    LimitedPlayer limited;
+    g2_.SetPlayer(&limited);
+    g2_.Play(limits);
+    EXPECT_EQ(limited.depth_, 3u);
+    g2_.Play();
+    EXPECT_EQ(limited.depth_, 0u);
+}
+
 }  // namespace
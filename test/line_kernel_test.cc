@@ -0,0 +1,85 @@
+#include "line_kernel.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "tile.h"
+#include "line.h"
+
+namespace {
+
+using _2048::LineKernel;
+using _2048::Tile;
+
+class LineKernelTest : public testing::Test {
+ protected:
+    std::vector<LineKernel> kernels_;
+
+    void SetUp() override {
+        for (auto kernel : {LineKernel::SCALAR, LineKernel::SSE4,
+                            LineKernel::AVX2})
+            if (kernel <= _2048::BestLineKernel())
+                kernels_.push_back(kernel);
+    }
+
+    // check every supported kernel against `MoveLine`
+    void ExpectSameAsMoveLine(const std::vector<uint8_t> &line) {
+        const uint32_t n = line.size();
+        std::vector<Tile> tiles;
+        for (uint8_t power : line)
+            tiles.emplace_back(power);
+        uint64_t score = 0;
+        uint32_t merges = 0;
+        uint32_t merged = 0;
+        const bool changed = _2048::MoveLine(
+                tiles.data(), n, 1, &score, &merges,
+                [&merged](uint32_t k) { merged |= 1u << k; });
+
+        for (auto kernel : kernels_) {
+            std::vector<uint8_t> powers(line);
+            uint64_t kernel_score = 1;
+            uint32_t kernel_merges = 1;
+            uint32_t kernel_merged = ~0u;
+            EXPECT_EQ(_2048::GetMovePowers(kernel)(
+                    powers.data(), n, &kernel_score, &kernel_merges,
+                    &kernel_merged), changed);
+            EXPECT_EQ(kernel_score, score + 1);
+            EXPECT_EQ(kernel_merges, merges + 1);
+            EXPECT_EQ(kernel_merged, merged);
+            for (uint32_t i = 0; i < n; i++)
+                EXPECT_EQ(powers[i], tiles[i].power());
+        }
+    }
+};
+
+TEST_F(LineKernelTest, Examples) {
+    ExpectSameAsMoveLine({});
+    ExpectSameAsMoveLine({0});
+    ExpectSameAsMoveLine({1, 1});
+    ExpectSameAsMoveLine({1, 1, 1});
+    ExpectSameAsMoveLine({1, 1, 1, 1, 0, 2, 0, 2, 3});
+    ExpectSameAsMoveLine({0, 0, 0, 0, 0, 0, 0, 0, 0, 5});
+    ExpectSameAsMoveLine(std::vector<uint8_t>(_2048::kMaxKernelLine, 1));
+    ExpectSameAsMoveLine(std::vector<uint8_t>(_2048::kMaxKernelLine, 0));
+    std::vector<uint8_t> distinct;
+    for (uint32_t i = 0; i < _2048::kMaxKernelLine; i++)
+        distinct.push_back(i + 1);
+    ExpectSameAsMoveLine(distinct);
+}
+
+TEST_F(LineKernelTest, RandomLines) {
+    std::mt19937_64 engine(32);
+    for (uint32_t n = 1; n <= _2048::kMaxKernelLine; n++)
+        for (uint32_t trial = 0; trial < 200; trial++) {
+            // few distinct powers so that merges are common
+            std::vector<uint8_t> line(n);
+            const uint32_t empty_rate = engine() % 4;
+            for (auto &power : line)
+                power = engine() % 4 < empty_rate ? 0 : engine() % 3 + 1;
+            ExpectSameAsMoveLine(line);
+        }
+}
+
+}  // namespace
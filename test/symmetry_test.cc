@@ -0,0 +1,110 @@
+#include "symmetry.h"
+
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+
+#include "game_state.h"
+#include "bit_board_4x4.h"
+
+namespace {
+
+using _2048::BitBoard4x4;
+using _2048::Canonical;
+using _2048::GameState;
+using _2048::Symmetry;
+
+class SymmetryTest : public testing::Test {
+ protected:
+    BitBoard4x4 b_;
+    GameState g_ = GameState(5, 5);
+
+    void SetUp() override {
+        // [[_,    2,  _,  4],
+        //  [_,    2,  _,  _],
+        //  [8,    4,  4,  _],
+        //  [2048, 64, 32, _]]
+        b_.GenerateTile(BitBoard4x4::Position(0, 1), 1);
+        b_.GenerateTile(BitBoard4x4::Position(0, 3), 2);
+        b_.GenerateTile(BitBoard4x4::Position(1, 1), 1);
+        b_.GenerateTile(BitBoard4x4::Position(2, 0), 3);
+        b_.GenerateTile(BitBoard4x4::Position(2, 1), 2);
+        b_.GenerateTile(BitBoard4x4::Position(2, 2), 2);
+        b_.GenerateTile(BitBoard4x4::Position(3, 0), 11);
+        b_.GenerateTile(BitBoard4x4::Position(3, 1), 6);
+        b_.GenerateTile(BitBoard4x4::Position(3, 2), 5);
+        std::mt19937_64 engine(5);
+        for (uint32_t i = 0; i < 15; i++)
+            g_.GenerateTile(g_.GetEmptyTile(engine() % g_.CountEmptyTiles()),
+                            engine() % 8 + 1);
+    }
+};
+
+TEST_F(SymmetryTest, Inverse) {
+    for (uint8_t i = 0; i < Symmetry::kCount; i++) {
+        Symmetry s(i);
+        EXPECT_EQ(s.Inverse().Inverse(), s);
+        for (uint32_t r = 0; r < 5; r++)
+            for (uint32_t c = 0; c < 5; c++) {
+                GameState::Position pos(r, c);
+                EXPECT_EQ(s.Inverse().Apply(s.Apply(pos, 5), 5), pos);
+            }
+        for (auto dir : GameState::kDirections)
+            EXPECT_EQ(s.Inverse().Apply(s.Apply(dir)), dir);
+        EXPECT_EQ(Transform(Transform(b_, s), s.Inverse()), b_);
+        EXPECT_EQ(Transform(Transform(g_, s), s.Inverse()), g_);
+    }
+}
+
+TEST_F(SymmetryTest, Transform) {
+    EXPECT_EQ(b_.Transpose().ToGameState(),
+              Transform(b_.ToGameState(), Symmetry(4)));
+    EXPECT_EQ(b_.MirrorRows().tile(BitBoard4x4::Position(0, 0)).power(), 11);
+    EXPECT_EQ(b_.MirrorCols().tile(BitBoard4x4::Position(0, 0)).power(), 2);
+    for (uint8_t i = 0; i < Symmetry::kCount; i++)
+        EXPECT_EQ(Transform(b_, Symmetry(i)).ToGameState(),
+                  Transform(b_.ToGameState(), Symmetry(i)));
+    EXPECT_THROW(Transform(GameState(4, 5), Symmetry(1)),
+                 std::invalid_argument);
+}
+
+TEST_F(SymmetryTest, Move) {
+    for (uint8_t i = 0; i < Symmetry::kCount; i++) {
+        Symmetry s(i);
+        for (auto dir : GameState::kDirections) {
+            BitBoard4x4 moved(b_);
+            BitBoard4x4 transformed(Transform(b_, s));
+            GameState::MoveResult expected = moved.Move(dir);
+            GameState::MoveResult actual = transformed.Move(s.Apply(dir));
+            EXPECT_EQ(actual.moved, expected.moved);
+            EXPECT_EQ(actual.score, expected.score);
+            EXPECT_EQ(Transform(moved, s), transformed);
+
+            GameState g(g_);
+            GameState tg = Transform(g_, s);
+            g.Move(dir);
+            tg.Move(s.Apply(dir));
+            EXPECT_EQ(Transform(g, s), tg);
+        }
+    }
+}
+
+TEST_F(SymmetryTest, Canonicalize) {
+    Canonical<BitBoard4x4> cb = Canonicalize(b_);
+    Canonical<GameState> cg = Canonicalize(g_);
+    EXPECT_EQ(Transform(b_, cb.symmetry), cb.board);
+    EXPECT_EQ(Transform(g_, cg.symmetry), cg.board);
+    EXPECT_EQ(Canonicalize(b_.ToGameState()).board, cb.board.ToGameState());
+    for (uint8_t i = 0; i < Symmetry::kCount; i++) {
+        Symmetry s(i);
+        BitBoard4x4 b = Transform(b_, s);
+        EXPECT_LE(cb.board.raw(), b.raw());
+        EXPECT_EQ(Canonicalize(b).board, cb.board);
+        EXPECT_EQ(Canonicalize(Transform(g_, s)).board, cg.board);
+    }
+    EXPECT_EQ(Canonicalize(BitBoard4x4()).symmetry, Symmetry());
+    EXPECT_THROW(Canonicalize(GameState(4, 5)), std::invalid_argument);
+}
+
+}  // namespace